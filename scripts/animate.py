@@ -6,6 +6,7 @@ import matplotlib
 matplotlib.use("Agg")
 
 import argparse
+from typing import Optional, Tuple
 import matplotlib.pyplot as plt
 from matplotlib import animation
 from matplotlib.colors import LinearSegmentedColormap
@@ -13,34 +14,261 @@ import numpy as np
 import pandas as pd
 
 
-def read_sim_history(datafile: str, num_rows: int, num_columns: int) -> pd.DataFrame:
-    """Read and extract from simulation datafile.
+HISTORY_HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S8"),
+        ("version", "<u4"),
+        ("header_bytes", "<u4"),
+        ("number_rows", "<u4"),
+        ("number_columns", "<u4"),
+        ("frame_bytes", "<u8"),
+        ("seed", "<u4"),
+        ("num_steps", "<i4"),
+        ("diffusion_substeps", "<i4"),
+        ("encoding", "<u4"),
+        ("probability_bacteria", "<f8"),
+        ("probability_divide", "<f8"),
+        ("consume_amount", "<f8"),
+        ("diffusion_rate", "<f8"),
+        ("max_nutrient", "<f8"),
+        ("keyframe_interval", "<u4"),
+        ("reserved", "<u4"),
+        ("nutrient_tolerance", "<f8"),
+    ]
+)
+
+HISTORY_FOOTER_DTYPE = np.dtype(
+    [("number_frames", "<u8"), ("index_offset", "<u8"), ("magic", "S8")]
+)
+
+
+def is_binary_history(datafile: str) -> bool:
+    """Check if simulation datafile uses the binary history format.
 
     Parameters
     ----------
     datafile : str
         File containing biofilm simulation history.
 
+    Returns
+    -------
+    is_binary : bool
+        True if the file starts with the binary history header.
+    """
+    with open(datafile, "rb") as f:
+        return f.read(8) == b"BIOFILM\0"
+
+
+def decode_zero_runs(encoded: bytes, previous: np.ndarray) -> np.ndarray:
+    """Decode a run-length encoded delta and apply it to the previous frame.
+
+    Parameters
+    ----------
+    encoded : bytes
+        Runs of a zero count, a value count, and the values, all stored as
+        LEB128 variable-length integers.
+
+    previous : np.ndarray
+        Plane of the previous frame, or zeros for a keyframe.
+
+    Returns
+    -------
+    current : np.ndarray
+        Plane of the current frame, the previous plane XORed with the delta.
+    """
+    current: np.ndarray = previous.copy()
+    position: int = 0
+    cell_id: int = 0
+
+    def next_varint() -> int:
+        nonlocal position
+        value: int = 0
+        shift: int = 0
+        while True:
+            byte: int = encoded[position]
+            position += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    while position < len(encoded):
+        cell_id += next_varint()
+        for _ in range(next_varint()):
+            current[cell_id] ^= next_varint()
+            cell_id += 1
+
+    return current
+
+
+def read_delta_history(
+    datafile: str, header: np.void, footer: np.void
+) -> Tuple[np.ndarray, np.ndarray]:
+    """Decode the frames of a delta encoded simulation datafile.
+
+    Parameters
+    ----------
+    datafile : str
+        File containing biofilm simulation history in the delta format.
+
+    header : np.void
+        Header of the datafile.
+
+    footer : np.void
+        Footer of the datafile.
+
+    Returns
+    -------
+    bacteria : np.ndarray
+        Bacteria states with shape (frames, rows, columns).
+
+    nutrients : np.ndarray
+        Nutrients states with shape (frames, rows, columns).
+    """
+    num_rows: int = int(header["number_rows"])
+    num_columns: int = int(header["number_columns"])
+    num_frames: int = int(footer["number_frames"])
+    frame_dtype = np.dtype(
+        [
+            ("step", "<i4"),
+            ("keyframe", "<u4"),
+            ("bacteria_bytes", "<u8"),
+            ("nutrients_bytes", "<u8"),
+        ]
+    )
+
+    num_cells: int = num_rows * num_columns
+    bacteria: np.ndarray = np.zeros((num_frames, num_cells), dtype=np.uint8)
+    quantized: np.ndarray = np.zeros((num_frames, num_cells), dtype=np.uint32)
+
+    with open(datafile, "rb") as f:
+        f.seek(int(footer["index_offset"]))
+        frame_offsets: np.ndarray = np.fromfile(f, dtype="<u8", count=num_frames)
+
+        for frame, frame_offset in enumerate(frame_offsets):
+            f.seek(int(frame_offset))
+            frame_header = np.fromfile(f, dtype=frame_dtype, count=1)[0]
+            bacteria_runs: bytes = f.read(int(frame_header["bacteria_bytes"]))
+            nutrients_runs: bytes = f.read(int(frame_header["nutrients_bytes"]))
+
+            keyframe: bool = frame == 0 or bool(frame_header["keyframe"])
+            previous_frame: int = frame if keyframe else frame - 1
+            bacteria[frame] = decode_zero_runs(
+                bacteria_runs, bacteria[previous_frame]
+            )
+            quantized[frame] = decode_zero_runs(
+                nutrients_runs, quantized[previous_frame]
+            )
+
+    nutrients: np.ndarray = quantized * float(header["nutrient_tolerance"])
+    shape = (num_frames, num_rows, num_columns)
+
+    return bacteria.reshape(shape), nutrients.reshape(shape)
+
+
+def read_binary_history(datafile: str) -> Tuple[np.ndarray, np.ndarray]:
+    """Memory map the frames of a binary simulation datafile.
+
+    Delta encoded datafiles cannot be memory mapped and are decoded instead.
+
+    Parameters
+    ----------
+    datafile : str
+        File containing biofilm simulation history in the binary or delta
+        format.
+
+    Returns
+    -------
+    bacteria : np.ndarray
+        Bacteria states with shape (frames, rows, columns).
+
+    nutrients : np.ndarray
+        Nutrients states with shape (frames, rows, columns).
+    """
+    with open(datafile, "rb") as f:
+        header = np.fromfile(f, dtype=HISTORY_HEADER_DTYPE, count=1)[0]
+        f.seek(-HISTORY_FOOTER_DTYPE.itemsize, 2)
+        footer = np.fromfile(f, dtype=HISTORY_FOOTER_DTYPE, count=1)[0]
+
+    if footer["magic"] != b"BIOFIDX":
+        raise ValueError(f"{datafile} has no step index, was the run cut short?")
+
+    if int(header["encoding"]) == 1:
+        return read_delta_history(datafile, header, footer)
+
+    num_rows: int = int(header["number_rows"])
+    num_columns: int = int(header["number_columns"])
+    num_cells: int = num_rows * num_columns
+    bacteria_bytes: int = (num_cells + 7) // 8 * 8
+
+    frame_dtype = np.dtype(
+        {
+            "names": ["step", "bacteria", "nutrients"],
+            "formats": [
+                "<i4",
+                ("u1", (num_rows, num_columns)),
+                ("<f4", (num_rows, num_columns)),
+            ],
+            "offsets": [0, 8, 8 + bacteria_bytes],
+            "itemsize": int(header["frame_bytes"]),
+        }
+    )
+
+    frames: np.ndarray = np.memmap(
+        datafile,
+        dtype=frame_dtype,
+        mode="r",
+        offset=int(header["header_bytes"]),
+        shape=(int(footer["number_frames"]),),
+    )
+
+    return frames["bacteria"], frames["nutrients"]
+
+
+def read_sim_history(
+    datafile: str, num_rows: int, num_columns: int
+) -> Tuple[np.ndarray, np.ndarray]:
+    """Read and extract from simulation datafile.
+
+    Parameters
+    ----------
+    datafile : str
+        File containing biofilm simulation history, in the csv, binary, or
+        delta format.
+
     num_rows : int
-        Number of rows in simulation.
+        Number of rows in simulation (csv format only).
 
     num_columns : int
-        Number of columns in simulation.
+        Number of columns in simulation (csv format only).
 
     Returns
     -------
-    biofilm_history : pd.DataFrame
-        Data frame of biofilm simulation history.
+    bacteria : np.ndarray
+        Bacteria states with shape (frames, rows, columns).
+
+    nutrients : np.ndarray
+        Nutrients states with shape (frames, rows, columns).
     """
-    biofilm_history: pd.DataFrame = pd.read_csv(datafile)
-    biofilm_history["row"] = biofilm_history["cell_id"] // num_columns
-    biofilm_history["column"] = biofilm_history["cell_id"] % num_columns
+    if is_binary_history(datafile):
+        return read_binary_history(datafile)
 
-    return biofilm_history
+    if num_rows is None or num_columns is None:
+        raise ValueError("rows and columns are required to read a csv history file")
+
+    biofilm_history: pd.DataFrame = pd.read_csv(datafile).sort_values(
+        ["step", "cell_id"]
+    )
+    shape = (-1, num_rows, num_columns)
+    bacteria: np.ndarray = biofilm_history["bacterium_state"].values.reshape(shape)
+    nutrients: np.ndarray = biofilm_history["nutrient_state"].values.reshape(shape)
+
+    return bacteria, nutrients
 
 
 def build_animation(
-    biofilm_history: pd.DataFrame,
+    bacteria: np.ndarray,
+    nutrients: np.ndarray,
     dpi: float,
     interval: int,
     fig_width: float = 8,
@@ -50,8 +278,11 @@ def build_animation(
 
     Parameters
     ----------
-    biofilm_history : pd.DataFrame
-        Data frame of biofilm simulation history.
+    bacteria : np.ndarray
+        Bacteria states with shape (frames, rows, columns).
+
+    nutrients : np.ndarray
+        Nutrients states with shape (frames, rows, columns).
 
     dpi : float, optional
         Animation resolution in dots per inch
@@ -70,21 +301,7 @@ def build_animation(
     anim : animation.FuncAnimation
         Animated object for the simulation run.
     """
-    number_rows: int = len(biofilm_history["row"].unique())
-    number_columns: int = len(biofilm_history["column"].unique())
-    number_frames: int = len(biofilm_history["step"].unique())
-
-    bacteria_df: pd.DataFrame = (
-        biofilm_history.query("step == 0")
-        .loc[:, ["row", "column", "bacterium_state"]]
-        .pivot("row", "column", "bacterium_state")
-    )
-
-    nutrients_df: pd.DataFrame = (
-        biofilm_history.query("step == 0")
-        .loc[:, ["row", "column", "nutrient_state"]]
-        .pivot("row", "column", "nutrient_state")
-    )
+    number_frames, number_rows, number_columns = bacteria.shape
 
     fig, ax = plt.subplots(figsize=(fig_width, fig_height), ncols=2, dpi=dpi)
 
@@ -93,11 +310,11 @@ def build_animation(
     )
 
     im_bacteria = ax[0].imshow(
-        bacteria_df.values, cmap=cmap, interpolation="nearest", vmin=0, vmax=2
+        bacteria[0], cmap=cmap, interpolation="nearest", vmin=0, vmax=2
     )
 
     im_nutrients = ax[1].imshow(
-        nutrients_df.values, cmap="viridis", interpolation="nearest", vmin=0, vmax=1
+        nutrients[0], cmap="viridis", interpolation="nearest", vmin=0, vmax=1
     )
 
     xticks_start_bac, xticks_end_bac = ax[0].get_xlim()
@@ -137,18 +354,8 @@ def build_animation(
         return (im_bacteria, im_nutrients)
 
     def animate(frame):
-        bacteria_df = (
-            biofilm_history.query(f"step == {frame}")
-            .loc[:, ["row", "column", "bacterium_state"]]
-            .pivot("row", "column", "bacterium_state")
-        )
-        nutrients_df = (
-            biofilm_history.query(f"step == {frame}")
-            .loc[:, ["row", "column", "nutrient_state"]]
-            .pivot("row", "column", "nutrient_state")
-        )
-        im_bacteria.set_array(bacteria_df.values)
-        im_nutrients.set_array(nutrients_df.values)
+        im_bacteria.set_array(bacteria[frame])
+        im_nutrients.set_array(nutrients[frame])
 
         return (im_bacteria, im_nutrients)
 
@@ -169,8 +376,8 @@ def build_animation(
 
 def animate_simulation(
     datafile: str,
-    num_rows: int,
-    num_columns: int,
+    num_rows: Optional[int] = None,
+    num_columns: Optional[int] = None,
     writer: str = "imagemagick",
     dpi: int = 150,
     fps: int = 30,
@@ -184,10 +391,10 @@ def animate_simulation(
         File containing biofilm simulation history.
 
     num_rows : int
-        Number of rows in simulation.
+        Number of rows in simulation (csv format only).
 
     num_columns : int
-        Number of columns in simulation.
+        Number of columns in simulation (csv format only).
 
     writer : str, optional
         Animation writer, 'imagemagick' outputs an animated gif image and
@@ -202,9 +409,9 @@ def animate_simulation(
     interval: int
         Set sampling interval for animation.
     """
-    biofilm_history: pd.DataFrame = read_sim_history(datafile, num_rows, num_columns)
+    bacteria, nutrients = read_sim_history(datafile, num_rows, num_columns)
     anim: animation.FuncAnimation = build_animation(
-        biofilm_history, dpi=dpi, interval=interval
+        bacteria, nutrients, dpi=dpi, interval=interval
     )
 
     if writer == "imagemagick":
@@ -219,8 +426,18 @@ if __name__ == "__main__":
     parser.add_argument(
         "datafile", type=str, help="File containing biofilm simulation history."
     )
-    parser.add_argument("rows", type=int, help="Number of rows in simulation.")
-    parser.add_argument("columns", type=int, help="Number of columns in simulation.")
+    parser.add_argument(
+        "rows",
+        type=int,
+        nargs="?",
+        help="Number of rows in simulation (csv history files only).",
+    )
+    parser.add_argument(
+        "columns",
+        type=int,
+        nargs="?",
+        help="Number of columns in simulation (csv history files only).",
+    )
     parser.add_argument(
         "--writer",
         type=str,
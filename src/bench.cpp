@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <CLI11.hpp>
+
+#include <consumption_system.hpp>
+#include <copy_system.hpp>
+#include <data.hpp>
+#include <diffusion_system.hpp>
+#include <entities.hpp>
+#include <growth_system.hpp>
+#include <initializers.hpp>
+#include <neighbors.hpp>
+#include <utilities.hpp>
+
+namespace bench {
+/// Model parameters the kernels are benchmarked with, the simulation defaults.
+static const double kDiffusionRate = 0.1;
+static const double kProbabilityDivide = 0.3;
+static const double kConsumeAmount = 0.1;
+
+/// Grid state and inputs shared by every kernel benchmarked on one grid.
+struct Fixture {
+  Entities prepared;                         ///< State every repetition starts from.
+  Entities entities;                         ///< State the kernels run on.
+  data::ActiveCells prepared_active_cells;   ///< Live bacteria of prepared state.
+  data::ActiveCells active_cells;            ///< Live bacteria of entities.
+  data::GetNeighborsParameters get_neighbors_parameters;
+  utilities::CellIdConverter cell_id_converter;
+  std::mt19937 random_engine;
+  double sink;   ///< Accumulates lookup results so they are not optimized out.
+
+  explicit Fixture(const data::Dimensions &dimensions)
+      : cell_id_converter(dimensions), sink(0.0) {}
+};
+
+/// A kernel to benchmark.
+struct Kernel {
+  std::string name;
+  bool restore;   ///< Whether the kernel changes its own inputs, in which case
+                  ///< every repetition starts from the prepared state.
+  std::function<void(Fixture &)> run;
+};
+
+/// Timing statistics of one kernel on one grid.
+struct Statistics {
+  double median;
+  double p10;
+  double p90;
+  double min;
+  double max;
+};
+
+/// Prepare a grid state as it is at the start of a time step.
+///
+/// Every unpadded cell holds a live bacterium with probability density and a
+/// uniformly random nutrients value, and both the states and their copies
+/// hold the same values with the padded region refreshed.
+///
+/// @param [in,out] fixture Fixture whose prepared state is filled in.
+/// @param [in] dimensions Dimensions of the unpadded grid.
+/// @param [in] density Fraction of cells that hold a live bacterium.
+/// @param [in] seed Random number generator seed.
+static void prepare_fixture(
+    Fixture &fixture, const data::Dimensions &dimensions, double density,
+    uint32_t seed) {
+  int cells_per_row = dimensions.number_columns + 2 * dimensions.size_padding;
+  std::mt19937 random_engine(seed);
+  std::uniform_real_distribution<double> uniform_rng(0.0, 1.0);
+
+  data::InitializationParameters parameters{dimensions, 0.0, 1.0, false};
+  utilities::IndexConverter indexer(cells_per_row);
+  Entities entities =
+      initializers::initialize_entities(parameters, indexer, random_engine);
+
+  for (int row = entities.first_unpadded_row(); row <= entities.last_unpadded_row();
+       row++) {
+    for (int column = entities.first_unpadded_column();
+         column <= entities.last_unpadded_column(); column++) {
+      Entities::EntityID id = row * cells_per_row + column;
+      bool bacterium = uniform_rng(random_engine) < density;
+      entities.bacteria_[id] =
+          bacterium ? Entities::kStateBacterium : Entities::kStateEmpty;
+      entities.nutrients_[id] = uniform_rng(random_engine);
+    }
+  }
+  entities.bacteria_copy_ = entities.bacteria_;
+  entities.nutrients_copy_ = entities.nutrients_;
+  transformers::refresh_padded_states(entities, cells_per_row);
+  transformers::refresh_bitboards(entities);
+
+  data::GetNeighborsParameters &get_neighbors_parameters =
+      fixture.get_neighbors_parameters;
+  get_neighbors_parameters.cells_per_row = cells_per_row;
+  get_neighbors_parameters.first_unpadded_row = entities.first_unpadded_row();
+  get_neighbors_parameters.last_unpadded_row = entities.last_unpadded_row();
+  get_neighbors_parameters.wraparound_shift =
+      (dimensions.number_rows - 1) * cells_per_row;
+  get_neighbors_parameters.first_unpadded_column = entities.first_unpadded_column();
+  get_neighbors_parameters.last_unpadded_column = entities.last_unpadded_column();
+
+  fixture.prepared_active_cells = initializers::initialize_active_cells(entities);
+  fixture.active_cells = fixture.prepared_active_cells;
+  fixture.prepared = entities;
+  fixture.entities = entities;
+  fixture.random_engine.seed(seed);
+}
+
+/// Kernels that can be benchmarked, in the order they run in a time step.
+///
+/// @return List of kernels.
+static std::vector<Kernel> list_kernels() {
+  std::vector<Kernel> kernels;
+
+  kernels.push_back(Kernel{"refresh_padded_states", false, [](Fixture &f) {
+                             transformers::refresh_padded_states(
+                                 f.entities, f.entities.cells_per_row());
+                           }});
+  kernels.push_back(Kernel{"diffusion_gather", false, [](Fixture &f) {
+                             transformers::apply_diffusion_transformation(
+                                 f.entities, kDiffusionRate, f.get_neighbors_parameters);
+                           }});
+  kernels.push_back(Kernel{"diffusion_rows", false, [](Fixture &f) {
+                             transformers::apply_row_diffusion_transformation(
+                                 f.entities, kDiffusionRate, f.entities.cells_per_row());
+                           }});
+  kernels.push_back(Kernel{"growth_scan", true, [](Fixture &f) {
+                             transformers::apply_growth_transformation(
+                                 f.entities, kProbabilityDivide,
+                                 f.get_neighbors_parameters, f.random_engine,
+                                 f.cell_id_converter);
+                           }});
+  kernels.push_back(Kernel{"growth_frontier", true, [](Fixture &f) {
+                             transformers::apply_frontier_growth_transformation(
+                                 f.entities, f.active_cells, kProbabilityDivide,
+                                 f.get_neighbors_parameters, f.random_engine,
+                                 f.cell_id_converter);
+                           }});
+  kernels.push_back(Kernel{"growth_bitboard", true, [](Fixture &f) {
+                             transformers::apply_bitboard_growth_transformation(
+                                 f.entities, kProbabilityDivide,
+                                 f.get_neighbors_parameters, f.random_engine,
+                                 f.cell_id_converter);
+                           }});
+  kernels.push_back(Kernel{"consumption", true, [](Fixture &f) {
+                             transformers::apply_consumption_transformation(
+                                 f.entities, kConsumeAmount);
+                           }});
+  kernels.push_back(Kernel{"neighbors_nutrient", false, [](Fixture &f) {
+                             const Entities &entities = f.entities;
+                             int cells_per_row = entities.cells_per_row();
+                             data::Nutrient sum = 0.0;
+                             for (int row = entities.first_unpadded_row();
+                                  row <= entities.last_unpadded_row(); row++) {
+                               for (int column = entities.first_unpadded_column();
+                                    column <= entities.last_unpadded_column();
+                                    column++) {
+                                 data::EightNeighborIDs ids =
+                                     neighbors::get_nutrient_neighbor_ids(
+                                         row * cells_per_row + column, entities,
+                                         f.get_neighbors_parameters);
+                                 data::EightNutrients values =
+                                     neighbors::get_nutrient_neighbor_values(
+                                         entities, ids);
+                                 sum += values[0] + values[7];
+                               }
+                             }
+                             f.sink += sum;
+                           }});
+  kernels.push_back(Kernel{"neighbors_bacterium", false, [](Fixture &f) {
+                             const Entities &entities = f.entities;
+                             int cells_per_row = entities.cells_per_row();
+                             int empty = 0;
+                             for (int row = entities.first_unpadded_row();
+                                  row <= entities.last_unpadded_row(); row++) {
+                               for (int column = entities.first_unpadded_column();
+                                    column <= entities.last_unpadded_column();
+                                    column++) {
+                                 empty += neighbors::check_for_empty_neighbors(
+                                     row * cells_per_row + column, entities,
+                                     f.get_neighbors_parameters);
+                               }
+                             }
+                             f.sink += empty;
+                           }});
+
+  return kernels;
+}
+
+/// Interpolated percentile of sorted samples.
+///
+/// @param [in] sorted Samples in ascending order.
+/// @param [in] fraction Percentile as a fraction between 0 and 1.
+/// @return Value of the percentile.
+static double get_percentile(const std::vector<double> &sorted, double fraction) {
+  double position = fraction * (sorted.size() - 1);
+  int lower = static_cast<int>(position);
+  int upper = std::min(lower + 1, static_cast<int>(sorted.size()) - 1);
+
+  return sorted[lower] + (position - lower) * (sorted[upper] - sorted[lower]);
+}
+
+/// Time one kernel on a prepared fixture.
+///
+/// Kernels that change their own inputs start every run from the prepared
+/// state, and the copy is not timed.
+///
+/// @param [in,out] fixture Fixture the kernel runs on.
+/// @param [in] kernel Kernel to time.
+/// @param [in] warmup Number of untimed runs before the timed ones.
+/// @param [in] repetitions Number of timed runs.
+/// @return Statistics of the timed runs, in seconds.
+static Statistics
+time_kernel(Fixture &fixture, const Kernel &kernel, int warmup, int repetitions) {
+  std::vector<double> samples;
+
+  fixture.entities = fixture.prepared;
+  fixture.active_cells = fixture.prepared_active_cells;
+  for (int run = 0; run < warmup + repetitions; run++) {
+    if (kernel.restore) {
+      fixture.entities = fixture.prepared;
+      fixture.active_cells = fixture.prepared_active_cells;
+    }
+
+    auto timer = utilities::read_timer();
+    kernel.run(fixture);
+    double seconds =
+        std::chrono::duration<double>(utilities::read_timer() - timer).count();
+
+    if (run >= warmup) {
+      samples.push_back(seconds);
+    }
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  return Statistics{
+      get_percentile(samples, 0.5), get_percentile(samples, 0.1),
+      get_percentile(samples, 0.9), samples.front(), samples.back()};
+}
+}   // namespace bench
+
+int main(int argc, char **argv) {
+
+  CLI::App app{"Microbenchmarks for the biofilm simulation kernels"};
+
+  std::vector<int> sizes = {128, 512, 2048};
+  app.add_option(
+      "--sizes", sizes,
+      "Numbers of rows and columns of the square grids [default: 128 512 2048]");
+
+  std::vector<double> densities = {0.05, 0.5, 0.95};
+  app.add_option(
+         "--densities", densities,
+         "Fractions of cells holding a live bacterium [default: 0.05 0.5 0.95]")
+      ->check(CLI::Range(0.0, 1.0));
+
+  std::vector<std::string> kernel_names;
+  app.add_option(
+      "-k,--kernels", kernel_names, "Names of the kernels to run [default: all]");
+
+  int warmup = 3;
+  app.add_option("--warmup", warmup, "Untimed runs before timing [default: 3]")
+      ->check(CLI::Range(0, 1000000));
+
+  int repetitions = 20;
+  app.add_option("-r,--repetitions", repetitions, "Timed runs [default: 20]")
+      ->check(CLI::Range(1, 1000000));
+
+  uint32_t seed = 1;
+  app.add_option("--seed", seed, "Random number generator seed [default: 1]");
+
+  std::string output_filename = "";
+  app.add_option("-o,--output", output_filename, "Save results to csv file");
+
+  CLI11_PARSE(app, argc, argv);
+
+  std::vector<bench::Kernel> kernels;
+  for (const bench::Kernel &kernel : bench::list_kernels()) {
+    if (kernel_names.empty() ||
+        std::find(kernel_names.begin(), kernel_names.end(), kernel.name) !=
+            kernel_names.end()) {
+      kernels.push_back(kernel);
+    }
+  }
+  if (kernels.empty()) {
+    std::cout << "no kernels selected, exiting...\n";
+    return 1;
+  }
+
+  std::ofstream output_file;
+  if (!output_filename.empty()) {
+    output_file.open(output_filename);
+    output_file << "kernel,num_rows,num_columns,density,repetitions,median_time,"
+                   "p10_time,p90_time,min_time,max_time,ns_per_cell\r\n";
+  }
+
+  std::cout << std::left << std::setw(22) << "kernel" << std::right << std::setw(11)
+            << "grid" << std::setw(9) << "density" << std::setw(13) << "median [us]"
+            << std::setw(13) << "p10 [us]" << std::setw(13) << "p90 [us]"
+            << std::setw(13) << "ns/cell"
+            << "\n";
+
+  double sink = 0.0;
+  for (int size : sizes) {
+    for (double density : densities) {
+      data::Dimensions dimensions{size, size, 1};
+      bench::Fixture fixture(dimensions);
+      bench::prepare_fixture(fixture, dimensions, density, seed);
+      double number_cells = static_cast<double>(size) * size;
+
+      for (const bench::Kernel &kernel : kernels) {
+        bench::Statistics statistics =
+            bench::time_kernel(fixture, kernel, warmup, repetitions);
+        double ns_per_cell = statistics.median * 1e9 / number_cells;
+
+        std::cout << std::left << std::setw(22) << kernel.name << std::right
+                  << std::setw(11) << (std::to_string(size) + "x" + std::to_string(size))
+                  << std::setw(9) << density << std::fixed << std::setprecision(1)
+                  << std::setw(13) << statistics.median * 1e6 << std::setw(13)
+                  << statistics.p10 * 1e6 << std::setw(13) << statistics.p90 * 1e6
+                  << std::setprecision(3) << std::setw(13) << ns_per_cell
+                  << std::defaultfloat << std::setprecision(6) << "\n";
+
+        if (output_file) {
+          output_file << kernel.name << "," << size << "," << size << "," << density
+                      << "," << repetitions << "," << statistics.median << ","
+                      << statistics.p10 << "," << statistics.p90 << ","
+                      << statistics.min << "," << statistics.max << "," << ns_per_cell
+                      << "\r\n";
+        }
+      }
+      sink += fixture.sink;
+    }
+  }
+
+  // Printed so the neighbor lookups cannot be optimized out.
+  std::cout << "checksum = " << sink << "\n";
+
+  return 0;
+}
@@ -0,0 +1,269 @@
+#include <checkpoint.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <data.hpp>
+#include <utilities.hpp>
+
+namespace utilities {
+/// Write a value to a binary stream as raw bytes.
+///
+/// @param [in,out] f The binary stream.
+/// @param [in] value Value to write.
+template <typename T>
+static void write_value(std::ostream &f, const T &value) {
+  f.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/// Write a string to a binary stream, prefixed with its uint32 length.
+///
+/// @param [in,out] f The binary stream.
+/// @param [in] value String to write.
+static void write_string(std::ostream &f, const std::string &value) {
+  write_value(f, static_cast<uint32_t>(value.size()));
+  f.write(value.data(), value.size());
+}
+
+/// Read a value written by write_value.
+///
+/// @param [in,out] f The binary stream.
+/// @param [out] value Value read from the stream.
+template <typename T>
+static void read_value(std::istream &f, T &value) {
+  f.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+/// Read a string written by write_string.
+///
+/// @param [in,out] f The binary stream.
+/// @param [out] value String read from the stream.
+static void read_string(std::istream &f, std::string &value) {
+  uint32_t length = 0;
+  read_value(f, length);
+  value.assign(length, '\0');
+  f.read(&value[0], length);
+}
+
+/// Serialize the simulation parameters that define the simulated model.
+///
+/// Filenames and the options controlling output and checkpoints are left out,
+/// since they belong to the run rather than to the simulation state.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @return Serialized parameters.
+static std::string serialize_parameters(const cli_parameters_t &cli_parameters) {
+  std::ostringstream f;
+  write_value(f, cli_parameters.grid_dimensions[0]);
+  write_value(f, cli_parameters.grid_dimensions[1]);
+  write_value(f, cli_parameters.seed);
+  write_string(f, cli_parameters.rng_mode);
+  write_value(f, cli_parameters.num_steps);
+  write_value(f, cli_parameters.probability_bacteria);
+  write_value(f, cli_parameters.probability_divide);
+  write_value(f, cli_parameters.consume_amount);
+  write_value(f, cli_parameters.diffusion_rate);
+  write_value(f, cli_parameters.diffusion_substeps);
+  write_value(f, cli_parameters.max_nutrient);
+  write_string(f, cli_parameters.diffusion_engine);
+  write_string(f, cli_parameters.growth_engine);
+  write_string(f, cli_parameters.step_engine);
+
+  return f.str();
+}
+
+/// Deserialize the simulation parameters written by serialize_parameters.
+///
+/// @param [in,out] f The binary stream, positioned at the parameters.
+/// @param [out] cli_parameters Simulation parameters, only the serialized
+///   fields are set.
+static void deserialize_parameters(std::istream &f, cli_parameters_t &cli_parameters) {
+  cli_parameters.grid_dimensions.resize(2);
+  read_value(f, cli_parameters.grid_dimensions[0]);
+  read_value(f, cli_parameters.grid_dimensions[1]);
+  read_value(f, cli_parameters.seed);
+  read_string(f, cli_parameters.rng_mode);
+  read_value(f, cli_parameters.num_steps);
+  read_value(f, cli_parameters.probability_bacteria);
+  read_value(f, cli_parameters.probability_divide);
+  read_value(f, cli_parameters.consume_amount);
+  read_value(f, cli_parameters.diffusion_rate);
+  read_value(f, cli_parameters.diffusion_substeps);
+  read_value(f, cli_parameters.max_nutrient);
+  read_string(f, cli_parameters.diffusion_engine);
+  read_string(f, cli_parameters.growth_engine);
+  read_string(f, cli_parameters.step_engine);
+}
+
+/// Read and check the header of a checkpoint file.
+///
+/// @param [in,out] f The checkpoint file stream, positioned at the start.
+/// @param [out] header Header read from the file.
+/// @return Whether the header is valid for this build.
+static bool read_checkpoint_header(std::istream &f, data::CheckpointHeader &header) {
+  read_value(f, header);
+
+  return f && std::memcmp(header.magic, "BIOFCKP", 8) == 0 && header.version == 1 &&
+         header.nutrient_bytes == sizeof(data::Nutrient);
+}
+
+/// Save a checkpoint of the full simulation state.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] step Number of time steps completed.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @return Whether the checkpoint was saved.
+bool save_checkpoint(
+    const cli_parameters_t &cli_parameters, int step, const Entities &entities,
+    const std::mt19937 &random_engine) {
+  component::Bacteria bacteria;
+  component::Nutrients nutrients;
+  copy_unpadded_grid(entities, bacteria, nutrients);
+
+  return save_checkpoint(cli_parameters, step, bacteria, nutrients, random_engine);
+}
+
+/// Save a checkpoint of the full simulation state.
+///
+/// The checkpoint is written to a temporary file first and then renamed, so a
+/// run that dies while saving keeps its previous checkpoint.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] step Number of time steps completed.
+/// @param [in] bacteria Bacteria states of the unpadded grid, ordered by cell id.
+/// @param [in] nutrients Nutrients states of the unpadded grid, ordered by cell
+///   id.
+/// @param [in] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @return Whether the checkpoint was saved.
+bool save_checkpoint(
+    const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients,
+    const std::mt19937 &random_engine) {
+  std::string parameters = serialize_parameters(cli_parameters);
+  std::ostringstream random_engine_state;
+  random_engine_state << random_engine;
+
+  data::CheckpointHeader header{};
+  std::memcpy(header.magic, "BIOFCKP", 8);
+  header.version = 1;
+  header.nutrient_bytes = sizeof(data::Nutrient);
+  header.step = step;
+  header.number_rows = cli_parameters.grid_dimensions[0];
+  header.number_columns = cli_parameters.grid_dimensions[1];
+  header.parameters_bytes = parameters.size();
+  header.random_engine_bytes = random_engine_state.str().size();
+
+  std::string temporary_filename = cli_parameters.checkpoint_filename + ".tmp";
+  std::ofstream f(temporary_filename, std::ios::binary);
+  write_value(f, header);
+  f.write(parameters.data(), parameters.size());
+  f.write(random_engine_state.str().data(), header.random_engine_bytes);
+  f.write(reinterpret_cast<const char *>(bacteria.data()), bacteria.size());
+  f.write(
+      reinterpret_cast<const char *>(nutrients.data()),
+      nutrients.size() * sizeof(data::Nutrient));
+  f.close();
+
+  return f && std::rename(
+                  temporary_filename.c_str(),
+                  cli_parameters.checkpoint_filename.c_str()) == 0;
+}
+
+/// Read the step and simulation parameters saved in a checkpoint file.
+///
+/// @param [in] filename Checkpoint filename.
+/// @param [out] saved_parameters Simulation parameters saved in the checkpoint,
+///   only the fields defining the simulated model are set.
+/// @param [out] step Number of time steps completed.
+/// @return Whether the checkpoint could be read.
+bool read_checkpoint_parameters(
+    const std::string &filename, cli_parameters_t &saved_parameters, int &step) {
+  std::ifstream f(filename, std::ios::binary);
+  data::CheckpointHeader header{};
+  if (!read_checkpoint_header(f, header)) {
+    return false;
+  }
+
+  deserialize_parameters(f, saved_parameters);
+  step = header.step;
+
+  return static_cast<bool>(f);
+}
+
+/// Restore the bacteria and nutrients states and the Mersenne Twister engine
+/// from a checkpoint file.
+///
+/// Both buffers of the bacteria and nutrients components are restored, and
+/// the padded cells keep the values set by initialize_entities. Only the rows
+/// held by the entities are read, so each MPI process can restore its own slab.
+///
+/// @param [in] filename Checkpoint filename.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids, already initialized.
+/// @param [in] row_offset Row of the full grid that the entities' first
+///   unpadded row corresponds to.
+/// @param [out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @return Whether the checkpoint could be read.
+bool restore_checkpoint(
+    const std::string &filename, Entities &entities, int row_offset,
+    std::mt19937 &random_engine) {
+  std::ifstream f(filename, std::ios::binary);
+  data::CheckpointHeader header{};
+  if (!read_checkpoint_header(f, header)) {
+    return false;
+  }
+
+  f.seekg(header.parameters_bytes, std::ios::cur);
+  std::string random_engine_state(header.random_engine_bytes, '\0');
+  f.read(&random_engine_state[0], header.random_engine_bytes);
+  std::istringstream(random_engine_state) >> random_engine;
+
+  int cells_per_row = entities.cells_per_row();
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+  int first_column = entities.first_unpadded_column();
+  int number_columns = header.number_columns;
+  int64_t num_cells = static_cast<int64_t>(header.number_rows) * number_columns;
+  std::streamoff bacteria_offset = f.tellg();
+  std::streamoff nutrients_offset = bacteria_offset + num_cells;
+
+  for (int row = first_row; row <= last_row; row++) {
+    int64_t first_cell_id = static_cast<int64_t>(row_offset + row - first_row) *
+                            number_columns;
+    int first_id = row * cells_per_row + first_column;
+
+    f.seekg(bacteria_offset + first_cell_id);
+    f.read(reinterpret_cast<char *>(&entities.bacteria_[first_id]), number_columns);
+    f.seekg(nutrients_offset + first_cell_id * sizeof(data::Nutrient));
+    f.read(
+        reinterpret_cast<char *>(&entities.nutrients_[first_id]),
+        number_columns * sizeof(data::Nutrient));
+  }
+  entities.bacteria_copy_ = entities.bacteria_;
+  entities.nutrients_copy_ = entities.nutrients_;
+
+  return static_cast<bool>(f);
+}
+
+/// Check whether a checkpoint is due after a time step.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] step Number of time steps completed.
+/// @return Whether a checkpoint should be saved.
+bool check_checkpoint_due(const cli_parameters_t &cli_parameters, int step) {
+  return cli_parameters.checkpoint_every > 0 &&
+         step % cli_parameters.checkpoint_every == 0;
+}
+}   // namespace utilities
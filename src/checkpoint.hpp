@@ -0,0 +1,27 @@
+#ifndef BIOFILM_SIMULATION_CHECKPOINT_HPP
+#define BIOFILM_SIMULATION_CHECKPOINT_HPP
+
+#include <random>
+#include <string>
+
+#include <cli.hpp>
+#include <components.hpp>
+#include <entities.hpp>
+
+namespace utilities {
+bool save_checkpoint(
+    const cli_parameters_t &cli_parameters, int step, const Entities &entities,
+    const std::mt19937 &random_engine);
+bool save_checkpoint(
+    const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients,
+    const std::mt19937 &random_engine);
+bool read_checkpoint_parameters(
+    const std::string &filename, cli_parameters_t &saved_parameters, int &step);
+bool restore_checkpoint(
+    const std::string &filename, Entities &entities, int row_offset,
+    std::mt19937 &random_engine);
+bool check_checkpoint_due(const cli_parameters_t &cli_parameters, int step);
+}   // namespace utilities
+
+#endif   // BIOFILM_SIMULATION_CHECKPOINT_HPP
@@ -1,12 +1,43 @@
 #include <cli.hpp>
 
+#include <algorithm>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <mpi.h>
+
 #include <CLI11.hpp>
 
+#include <checkpoint.hpp>
 #include <simulation.hpp>
+#include <sweep.hpp>
+
+/// Largest grid, in cells, that ensembles run on. Beyond it the replicas run
+/// faster one by one (measured with 8 lanes: 1.32x on 20x20, 1.05x on 64x64,
+/// 1.01x on 96x96, 0.93x on 400x100).
+static const int kMaxEnsembleCells = 64 * 64;
+
+/// Print why the simulation cannot run and shut down MPI if it was started.
+///
+/// In mpi mode every rank checks the parameters and reaches the same verdict,
+/// so only rank 0 prints the message.
+///
+/// @param [in] message Reason the simulation cannot run.
+/// @param [in] use_mpi Whether MPI was initialized.
+/// @param [in] rank MPI rank of this process, 0 outside mpi mode.
+/// @return Exit status of the program.
+static int exit_with_error(const std::string &message, bool use_mpi, int rank) {
+  if (rank == 0) {
+    std::cout << message << ", exiting...\n";
+  }
+  if (use_mpi) {
+    MPI_Finalize();
+  }
+
+  return 1;
+}
 
 int main(int argc, char **argv) {
 
@@ -16,9 +47,15 @@ int main(int argc, char **argv) {
 
   std::string mode_option = "serial";
   app.add_set_ignore_case(
-      "mode", mode_option, {"serial"},
+      "mode", mode_option, {"serial", "openmp", "mpi", "sweep"},
       "\n\nBiofilm simulation run modes\n"
-      "  serial:   (default) Serial version of simulation.");
+      "  serial:   (default) Serial version of simulation.\n"
+      "  openmp:   Shared-memory version of simulation, threads set by\n"
+      "            OMP_NUM_THREADS.\n"
+      "  mpi:      Distributed-memory version of simulation, rows split\n"
+      "            across processes. Requires --rng philox.\n"
+      "  sweep:    Many serial simulations over a grid of parameters or a jobs\n"
+      "            file, run on a pool of --sweep-threads threads.");
 
   cli_parameters.grid_dimensions = {400, 100};
   app.add_option(
@@ -34,7 +71,34 @@ int main(int argc, char **argv) {
   cli_parameters.output_filename = "";
   app.add_option(
       "-o,--output", cli_parameters.output_filename,
-      "Save simulation history to csv file");
+      "Save simulation history to file");
+
+  cli_parameters.history_format = "csv";
+  app.add_set_ignore_case(
+      "--history-format", cli_parameters.history_format, {"csv", "binary", "delta"},
+      "Simulation history file format, binary stores one uint8 bacteria plane and "
+      "one float nutrients plane per step followed by an index of step offsets, "
+      "delta stores run-length encoded changes between steps with periodic "
+      "keyframes [default: csv]");
+
+  cli_parameters.keyframe_interval = 100;
+  app.add_option(
+         "--keyframe-every", cli_parameters.keyframe_interval,
+         "Steps between keyframes in delta history files [default: 100]")
+      ->check(CLI::Range(1, 1000000));
+
+  cli_parameters.nutrient_tolerance = 1.0E-4;
+  app.add_option(
+         "--nutrient-tolerance", cli_parameters.nutrient_tolerance,
+         "Quantization step for nutrients in delta history files [default: 1e-4]")
+      ->check(CLI::Range(1.0E-9, 1.0));
+
+  cli_parameters.history_queue_depth = 2;
+  app.add_option(
+         "--history-queue", cli_parameters.history_queue_depth,
+         "Number of history snapshots that can wait to be saved by the writer "
+         "thread before the simulation blocks [default: 2]")
+      ->check(CLI::Range(1, 64));
 
   cli_parameters.num_steps = 1000;
   app.add_option(
@@ -62,8 +126,49 @@ int main(int argc, char **argv) {
   cli_parameters.diffusion_rate = 0.1;
   app.add_option(
          "--diffusion-rate", cli_parameters.diffusion_rate,
-         "Diffusion rate for nutrients [default: 0.1]")
-      ->check(CLI::Range(0.0, 0.125));
+         "Diffusion rate for nutrients, at most 0.125 unless --diffusion-engine is "
+         "implicit [default: 0.1]")
+      ->check(CLI::Range(0.0, 1.0E6));
+
+  cli_parameters.diffusion_engine = "rows";
+  app.add_set_ignore_case(
+      "--diffusion-engine", cli_parameters.diffusion_engine,
+      {"rows", "gather", "blocked", "dirty", "implicit"},
+      "Diffusion kernel, rows sweeps whole rows with vector instructions, gather "
+      "looks up each cell's neighbors by id, blocked runs every substep on one "
+      "cache-sized tile of rows at a time (not in mpi mode), dirty skips tiles "
+      "whose nutrients stopped changing (not in mpi mode), implicit solves "
+      "tridiagonal systems along the rows and columns and is stable at any "
+      "diffusion rate (not in mpi mode) [default: rows]");
+
+  cli_parameters.diffusion_substeps = 1;
+  app.add_option(
+         "--diffusion-substeps", cli_parameters.diffusion_substeps,
+         "Diffusion substeps per time step [default: 1]")
+      ->check(CLI::Range(1, 1000));
+
+  cli_parameters.growth_engine = "frontier";
+  app.add_set_ignore_case(
+      "--growth-engine", cli_parameters.growth_engine, {"frontier", "scan", "bitboard"},
+      "Growth and consumption kernel, frontier visits only the live bacteria, scan "
+      "visits every cell, bitboard scans 64 cells at a time for empty neighbors "
+      "[default: frontier]");
+
+  cli_parameters.step_engine = "phased";
+  app.add_set_ignore_case(
+      "--step-engine", cli_parameters.step_engine, {"phased", "fused"},
+      "Time step kernel, phased sweeps the grid once per phase, fused diffuses, "
+      "grows, and consumes cache-sized tiles of rows in one sweep with the rows "
+      "diffusion kernel and the scan growth engine (serial and sweep modes only) "
+      "[default: phased]");
+
+  cli_parameters.steady_tolerance = 0.0;
+  app.add_option(
+         "--steady-tolerance", cli_parameters.steady_tolerance,
+         "Stop once a step changes no bacteria, no bacterium can divide, and no "
+         "cell's nutrients change by this much, 0 to disable (not for ensembles) "
+         "[default: 0]")
+      ->check(CLI::Range(0.0, 1.0));
 
   cli_parameters.max_nutrient = 1.0;
   app.add_option(
@@ -74,18 +179,247 @@ int main(int argc, char **argv) {
   cli_parameters.seed = rd();
   app.add_option("--seed", cli_parameters.seed, "Random number generator seed");
 
+  cli_parameters.rng_mode = "mt19937";
+  app.add_set_ignore_case(
+      "--rng", cli_parameters.rng_mode, {"mt19937", "philox"},
+      "Random number generator, philox draws are independent of visit order and "
+      "are required in mpi mode [default: mt19937]");
+
+  cli_parameters.checkpoint_every = 0;
+  app.add_option(
+         "--checkpoint-every", cli_parameters.checkpoint_every,
+         "Save a checkpoint every N time steps, 0 to disable [default: 0]")
+      ->check(CLI::Range(0, 1000000000));
+
+  cli_parameters.checkpoint_filename = "biofilm.ckpt";
+  app.add_option(
+      "--checkpoint-file", cli_parameters.checkpoint_filename,
+      "Checkpoint file, overwritten by every checkpoint [default: biofilm.ckpt]");
+
+  cli_parameters.restart_filename = "";
+  app.add_option(
+      "--restart", cli_parameters.restart_filename,
+      "Restart simulation from checkpoint file, the grid dimensions, seed, and "
+      "random number generator are taken from the checkpoint");
+
+  app.add_option(
+         "--sweep-prob-divide", cli_parameters.sweep_probability_divide,
+         "Division probabilities to sweep over in sweep mode")
+      ->check(CLI::Range(0.0, 1.0));
+
+  app.add_option(
+         "--sweep-diffusion-rate", cli_parameters.sweep_diffusion_rate,
+         "Diffusion rates to sweep over in sweep mode")
+      ->check(CLI::Range(0.0, 1.0E6));
+
+  app.add_option(
+         "--sweep-consume", cli_parameters.sweep_consume_amount,
+         "Consume amounts to sweep over in sweep mode")
+      ->check(CLI::Range(0.0, 1.0));
+
+  cli_parameters.sweep_replicas = 1;
+  app.add_option(
+         "--replicas", cli_parameters.sweep_replicas,
+         "Replicas of each parameter combination in sweep mode, seeded with --seed, "
+         "--seed + 1, ... [default: 1]")
+      ->check(CLI::Range(1, 1000000));
+
+  cli_parameters.sweep_jobs_filename = "";
+  app.add_option(
+      "--jobs", cli_parameters.sweep_jobs_filename,
+      "Jobs file for sweep mode, one 'seed prob-divide diffusion-rate consume' per "
+      "line, replaces the sweep parameter lists");
+
+  cli_parameters.sweep_threads = std::max(1u, std::thread::hardware_concurrency());
+  app.add_option(
+         "--sweep-threads", cli_parameters.sweep_threads,
+         "Number of simulations run at once in sweep mode [default: number of cores]")
+      ->check(CLI::Range(1, 4096));
+
+  cli_parameters.ensemble_lanes = 1;
+  app.add_option(
+         "--ensemble-lanes", cli_parameters.ensemble_lanes,
+         "Replicas run together in one interleaved ensemble in sweep mode, on grids "
+         "of at most 4096 cells with the default engines, 1 runs every replica on "
+         "its own [default: 1]")
+      ->check(CLI::Range(1, 64));
+
   CLI11_PARSE(app, argc, argv);
 
-  std::cout << "\n"
-            << "Biofilm simulation parameters"
-            << "\n"
-            << "-----------------------------"
-            << "\n";
-  cli_parameters.print_parameters();
-  std::cout << "\n";
+  //
+  // Every rank validates the parameters, only rank 0 reports
+  //
+  bool use_mpi = mode_option == "mpi";
+  int rank = 0;
+  if (use_mpi) {
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  }
+
+  //
+  // Restarted simulations continue with the saved parameters, except the
+  // ones passed explicitly on the command-line
+  //
+  cli_parameters.restart_step = 0;
+  if (!cli_parameters.restart_filename.empty()) {
+    cli_parameters_t saved_parameters;
+    if (!utilities::read_checkpoint_parameters(
+            cli_parameters.restart_filename, saved_parameters,
+            cli_parameters.restart_step)) {
+      return exit_with_error(
+          "could not read checkpoint " + cli_parameters.restart_filename, use_mpi, rank);
+    }
+
+    cli_parameters.grid_dimensions = saved_parameters.grid_dimensions;
+    cli_parameters.seed = saved_parameters.seed;
+    cli_parameters.rng_mode = saved_parameters.rng_mode;
+    cli_parameters.probability_bacteria = saved_parameters.probability_bacteria;
+    cli_parameters.max_nutrient = saved_parameters.max_nutrient;
+
+    if (app.count("--time-steps") == 0) {
+      cli_parameters.num_steps = saved_parameters.num_steps;
+    }
+    if (app.count("--prob-divide") == 0) {
+      cli_parameters.probability_divide = saved_parameters.probability_divide;
+    }
+    if (app.count("--consume") == 0) {
+      cli_parameters.consume_amount = saved_parameters.consume_amount;
+    }
+    if (app.count("--diffusion-rate") == 0) {
+      cli_parameters.diffusion_rate = saved_parameters.diffusion_rate;
+    }
+    if (app.count("--diffusion-substeps") == 0) {
+      cli_parameters.diffusion_substeps = saved_parameters.diffusion_substeps;
+    }
+    if (app.count("--diffusion-engine") == 0) {
+      cli_parameters.diffusion_engine = saved_parameters.diffusion_engine;
+    }
+    if (app.count("--growth-engine") == 0) {
+      cli_parameters.growth_engine = saved_parameters.growth_engine;
+    }
+    if (app.count("--step-engine") == 0) {
+      cli_parameters.step_engine = saved_parameters.step_engine;
+    }
+  }
+
+  if (cli_parameters.step_engine == "fused" && mode_option != "serial" &&
+      mode_option != "sweep") {
+    return exit_with_error(
+        "--step-engine fused requires serial or sweep mode", use_mpi, rank);
+  }
+
+  if (cli_parameters.step_engine == "fused" && cli_parameters.diffusion_substeps > 1) {
+    return exit_with_error(
+        "--step-engine fused requires --diffusion-substeps 1", use_mpi, rank);
+  }
+
+  //
+  // The fused engine runs the rows diffusion kernel and the scan growth engine,
+  // so it overrides the defaults (and the engines saved in a checkpoint) but
+  // rejects any other engine passed explicitly
+  //
+  if (cli_parameters.step_engine == "fused") {
+    if (app.count("--diffusion-engine") > 0 &&
+        cli_parameters.diffusion_engine != "rows") {
+      return exit_with_error(
+          "--step-engine fused requires --diffusion-engine rows", use_mpi, rank);
+    }
+    if (app.count("--growth-engine") > 0 && cli_parameters.growth_engine != "scan") {
+      return exit_with_error(
+          "--step-engine fused requires --growth-engine scan", use_mpi, rank);
+    }
+
+    if (cli_parameters.diffusion_engine != "rows") {
+      std::cout << "--step-engine fused overrides --diffusion-engine "
+                << cli_parameters.diffusion_engine << " with rows\n";
+      cli_parameters.diffusion_engine = "rows";
+    }
+    if (cli_parameters.growth_engine != "scan") {
+      std::cout << "--step-engine fused overrides --growth-engine "
+                << cli_parameters.growth_engine << " with scan\n";
+      cli_parameters.growth_engine = "scan";
+    }
+  }
+
+  if (cli_parameters.diffusion_engine != "implicit") {
+    double max_diffusion_rate = cli_parameters.diffusion_rate;
+    for (double diffusion_rate : cli_parameters.sweep_diffusion_rate) {
+      max_diffusion_rate = std::max(max_diffusion_rate, diffusion_rate);
+    }
+    if (max_diffusion_rate > 0.125) {
+      return exit_with_error(
+          "diffusion rates above 0.125 require --diffusion-engine implicit", use_mpi,
+          rank);
+    }
+  }
+
+  //
+  // Ensembles run their own diffusion, growth, and consumption kernels, which
+  // only beat running the replicas one by one on small grids
+  //
+  if (cli_parameters.ensemble_lanes > 1) {
+    if (cli_parameters.grid_dimensions[0] * cli_parameters.grid_dimensions[1] >
+        kMaxEnsembleCells) {
+      return exit_with_error(
+          "--ensemble-lanes requires grids of at most " +
+              std::to_string(kMaxEnsembleCells) + " cells",
+          use_mpi, rank);
+    }
+    if (app.count("--diffusion-engine") > 0 || app.count("--growth-engine") > 0 ||
+        app.count("--step-engine") > 0) {
+      return exit_with_error(
+          "--ensemble-lanes does not support --diffusion-engine, --growth-engine, or "
+          "--step-engine",
+          use_mpi, rank);
+    }
+    if (cli_parameters.steady_tolerance > 0.0) {
+      return exit_with_error(
+          "--ensemble-lanes does not support --steady-tolerance", use_mpi, rank);
+    }
+  }
+
+  if (cli_parameters.diffusion_engine == "dirty" &&
+      cli_parameters.diffusion_substeps > 1) {
+    return exit_with_error(
+        "--diffusion-engine dirty requires --diffusion-substeps 1", use_mpi, rank);
+  }
+
+  if (mode_option == "sweep" &&
+      (!cli_parameters.restart_filename.empty() || cli_parameters.checkpoint_every > 0)) {
+    return exit_with_error("sweep mode does not support checkpoints", use_mpi, rank);
+  }
+
+  if (use_mpi && cli_parameters.rng_mode != "philox") {
+    return exit_with_error("mpi mode requires --rng philox", use_mpi, rank);
+  }
+
+  if (use_mpi && (cli_parameters.diffusion_engine == "blocked" ||
+                  cli_parameters.diffusion_engine == "dirty" ||
+                  cli_parameters.diffusion_engine == "implicit")) {
+    return exit_with_error(
+        "mpi mode does not support --diffusion-engine " + cli_parameters.diffusion_engine,
+        use_mpi, rank);
+  }
+
+  if (rank == 0) {
+    std::cout << "\n"
+              << "Biofilm simulation parameters"
+              << "\n"
+              << "-----------------------------"
+              << "\n";
+    cli_parameters.print_parameters();
+    std::cout << "\n";
+  }
 
   if (mode_option == "serial") {
     serial::run_simulation(cli_parameters);
+  } else if (mode_option == "openmp") {
+    openmp::run_simulation(cli_parameters);
+  } else if (mode_option == "mpi") {
+    mpi::run_simulation(cli_parameters);
+    MPI_Finalize();
+  } else if (mode_option == "sweep") {
+    sweep::run_simulation(cli_parameters);
   } else {
     std::cout << mode_option << " is not a valid mode, exiting...\n";
   }
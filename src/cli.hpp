@@ -9,13 +9,34 @@ struct cli_parameters_t {
   std::vector<int> grid_dimensions;
   std::string summary_filename;
   std::string output_filename;
+  std::string history_format;
+  std::string checkpoint_filename;
+  std::string restart_filename;
+  std::string rng_mode;
+  std::string diffusion_engine;
+  std::string growth_engine;
+  std::string step_engine;
+  std::string sweep_jobs_filename;
+  std::vector<double> sweep_probability_divide;
+  std::vector<double> sweep_diffusion_rate;
+  std::vector<double> sweep_consume_amount;
   uint32_t seed;
   int num_steps;
+  int history_queue_depth;
+  int keyframe_interval;
+  int checkpoint_every;
+  int restart_step;
+  int diffusion_substeps;
+  int sweep_replicas;
+  int sweep_threads;
+  int ensemble_lanes;
   double consume_amount;
   double diffusion_rate;
   double probability_bacteria;
   double probability_divide;
   double max_nutrient;
+  double nutrient_tolerance;
+  double steady_tolerance;
 
   void print_parameters() {
     std::cout << "time steps                     = " << num_steps << "\n"
@@ -27,8 +48,26 @@ struct cli_parameters_t {
               << "diffusion rate                 = " << diffusion_rate << "\n"
               << "consume amount                 = " << consume_amount << "\n"
               << "rng seed                       = " << seed << "\n"
+              << "rng mode                       = " << rng_mode << "\n"
+              << "diffusion engine               = " << diffusion_engine << "\n"
+              << "diffusion substeps             = " << diffusion_substeps << "\n"
+              << "steady state tolerance         = " << steady_tolerance << "\n"
+              << "growth engine                  = " << growth_engine << "\n"
+              << "step engine                    = " << step_engine << "\n"
               << "benchmark summary filename     = " << summary_filename << "\n"
-              << "simulation history filename    = " << output_filename << "\n";
+              << "simulation history filename    = " << output_filename << "\n"
+              << "simulation history format      = " << history_format << "\n"
+              << "simulation history queue depth = " << history_queue_depth << "\n"
+              << "delta history keyframe every   = " << keyframe_interval << "\n"
+              << "delta history tolerance        = " << nutrient_tolerance << "\n"
+              << "checkpoint every               = " << checkpoint_every << "\n"
+              << "checkpoint filename            = " << checkpoint_filename << "\n"
+              << "restart filename               = " << restart_filename << "\n"
+              << "restart step                   = " << restart_step << "\n"
+              << "sweep jobs filename            = " << sweep_jobs_filename << "\n"
+              << "sweep replicas                 = " << sweep_replicas << "\n"
+              << "sweep threads                  = " << sweep_threads << "\n"
+              << "ensemble lanes                 = " << ensemble_lanes << "\n";
   }
 };
 #endif   // BIOFILM_SIMULATION_CLI_HPP
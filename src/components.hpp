@@ -9,10 +9,12 @@
 /// Aliases for the different components of the simulation.
 namespace component {
 using Names = std::vector<std::string>;
-using Bacteria = std::vector<int>;
-using Nutrients = std::vector<double>;
+using Bacteria = std::vector<data::BacteriumState>;
+using Nutrients = std::vector<data::Nutrient>;
 using CellIndices = std::vector<data::Index>;
 using CellLocations = std::vector<int>;
 using Flags = std::vector<uint32_t>;
+using Divisions = std::vector<int>;
+using Bitboard = std::vector<uint64_t>;
 }   // namespace component
 #endif   // BIOFILM_SIMULATION_COMPONENTS_HPP
@@ -11,23 +11,68 @@ namespace transformers {
 ///   nutrients and bacteria grids.
 /// @param [in] consumed Amount of nutrients each live bacterium consumes.
 void apply_consumption_transformation(Entities &entities, double consumed) {
-  // Count number of entities in simulation.
-  int num_entities = entities.names_.size();
-
-  // Mask: bacteria and nutrients components are active
-  uint32_t transform_flag = Entities::kFlagBacteria | Entities::kFlagNutrients;
-
-  // Loop over all entities regardless of active components.
-  for (Entities::EntityID id = 0; id < num_entities; id++) {
-    // Check if current entity's bacteria and nutrients components are active
-    uint32_t flag_check = transform_flag & entities.flags_[id];
-    if (flag_check == transform_flag) {
-      // If active, then check if bacteria is alive
-      if (entities.bacteria_[id] == Entities::kStateBacterium) {
-        // If alive, then consume nutrients.
-        entities.nutrients_[id] = std::max(0.0, entities.nutrients_[id] - consumed);
-      }
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+
+  // Loop over the unpadded rows.
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    consume_row(entities, consumed, row);
+  }
+}
+
+/// Decrease nutrients component of one unpadded row by fixed amount when
+/// bacterium is alive.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] consumed Amount of nutrients each live bacterium consumes.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+void consume_row(Entities &entities, double consumed, int row) {
+  int cells_per_row = entities.cells_per_row();
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+  // Loop over the entities in the row, whose bacteria and nutrients components
+  // are always active.
+  for (int column = first_column; column <= last_column; column++) {
+    Entities::EntityID id = row * cells_per_row + column;
+
+    // Check if bacteria is alive
+    if (entities.bacteria_[id] == Entities::kStateBacterium) {
+      // If alive, then consume nutrients.
+      entities.nutrients_[id] = std::max(
+          static_cast<data::Nutrient>(0.0),
+          static_cast<data::Nutrient>(entities.nutrients_[id] - consumed));
     }
   }
 }
+
+/// Decrease nutrients component by fixed amount for the live bacteria only.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] active_cells Entity ids of the live bacteria.
+/// @param [in] consumed Amount of nutrients each live bacterium consumes.
+void apply_frontier_consumption_transformation(
+    Entities &entities, const data::ActiveCells &active_cells, double consumed) {
+  int num_frontier = active_cells.frontier.size();
+  int num_interior = active_cells.interior.size();
+
+#pragma omp for schedule(static) nowait
+  for (int i = 0; i < num_frontier; i++) {
+    Entities::EntityID id = active_cells.frontier[i];
+    entities.nutrients_[id] = std::max(
+        static_cast<data::Nutrient>(0.0),
+        static_cast<data::Nutrient>(entities.nutrients_[id] - consumed));
+  }
+
+#pragma omp for schedule(static)
+  for (int i = 0; i < num_interior; i++) {
+    Entities::EntityID id = active_cells.interior[i];
+    entities.nutrients_[id] = std::max(
+        static_cast<data::Nutrient>(0.0),
+        static_cast<data::Nutrient>(entities.nutrients_[id] - consumed));
+  }
+}
 }   // namespace transformers
@@ -1,9 +1,13 @@
 #ifndef BIOFILM_SIMULATION_CONSUMPTION_SYSTEM_HPP
 #define BIOFILM_SIMULATION_CONSUMPTION_SYSTEM_HPP
 
+#include <data.hpp>
 #include <entities.hpp>
 
 namespace transformers {
 void apply_consumption_transformation(Entities &entities, double consumed);
+void consume_row(Entities &entities, double consumed, int row);
+void apply_frontier_consumption_transformation(
+    Entities &entities, const data::ActiveCells &active_cells, double consumed);
 }
 #endif   // BIOFILM_SIMULATION_CONSUMPTION_SYSTEM_HPP
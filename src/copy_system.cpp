@@ -1,69 +1,256 @@
 #include <copy_system.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <mpi.h>
+
 #include <entities.hpp>
 #include <utilities.hpp>
 
 namespace transformers {
+/// Swap the first and last unpadded rows of a component with the neighboring
+/// processes.
+///
+/// The grid is split into slabs of rows, one slab per process, and the slabs
+/// are arranged in a ring to keep the north and south boundaries periodic. The
+/// last unpadded row is sent to the next process and lands in its top padded
+/// row, and the first unpadded row is sent to the previous process and lands
+/// in its bottom padded row. With a single process, both messages are sent to
+/// itself.
+///
+/// @param [in,out] component Component whose padded rows are refreshed.
+/// @param [in] datatype MPI datatype of the component's elements.
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+/// @param [in] comm MPI communicator shared by the processes in the ring.
+template <typename T>
+void exchange_padded_rows(
+    std::vector<T> &component, MPI_Datatype datatype, int cells_per_row,
+    MPI_Comm comm) {
+  int rank;
+  int num_processes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &num_processes);
+
+  int previous_rank = (rank + num_processes - 1) % num_processes;
+  int next_rank = (rank + 1) % num_processes;
+
+  int num_entities = component.size();
+  int top_padded_row = 0;
+  int first_unpadded_row = cells_per_row;
+  int last_unpadded_row = num_entities - 2 * cells_per_row;
+  int bottom_padded_row = num_entities - cells_per_row;
+
+  MPI_Sendrecv(
+      &component[last_unpadded_row], cells_per_row, datatype, next_rank, 0,
+      &component[top_padded_row], cells_per_row, datatype, previous_rank, 0, comm,
+      MPI_STATUS_IGNORE);
+  MPI_Sendrecv(
+      &component[first_unpadded_row], cells_per_row, datatype, previous_rank, 1,
+      &component[bottom_padded_row], cells_per_row, datatype, next_rank, 1, comm,
+      MPI_STATUS_IGNORE);
+}
+
+/// Exchange padded (ghost) cell values with the processes holding the
+/// neighboring rows.
+///
+/// This is the distributed counterpart of refresh_padded_states. After the
+/// exchange, the top and bottom padded rows of bacteria_copy and nutrients_copy
+/// hold the rows that border this process's slab on the full grid.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+/// @param [in] comm MPI communicator shared by the processes in the ring.
+void exchange_padded_states(Entities &entities, int cells_per_row, MPI_Comm comm) {
+  exchange_padded_rows(entities.bacteria_copy_, MPI_UINT8_T, cells_per_row, comm);
+  exchange_padded_rows(
+      entities.nutrients_copy_, BIOFILM_MPI_NUTRIENT, cells_per_row, comm);
+}
+
+/// Exchange padded (ghost) nutrients with the processes holding the
+/// neighboring rows.
+///
+/// Used between diffusion substeps, when only the nutrients have changed.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+/// @param [in] comm MPI communicator shared by the processes in the ring.
+void exchange_padded_nutrients(Entities &entities, int cells_per_row, MPI_Comm comm) {
+  exchange_padded_rows(
+      entities.nutrients_copy_, BIOFILM_MPI_NUTRIENT, cells_per_row, comm);
+}
+
+/// Exchange proposed divisions with the processes holding the neighboring rows.
+///
+/// Bacteria in the first and last unpadded rows can divide into cells owned by
+/// a neighboring process. Divisions store the cell id of the full grid, so the
+/// received rows can be resolved without translating entity ids.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+/// @param [in] comm MPI communicator shared by the processes in the ring.
+void exchange_padded_divisions(Entities &entities, int cells_per_row, MPI_Comm comm) {
+  exchange_padded_rows(entities.divisions_, MPI_INT, cells_per_row, comm);
+}
+
 /// Refresh values of padded (ghost) cells that wrap around grid.
 ///
 /// Padded (ghost) cells are used to implement boundary conditions
-/// and keep track of component states from the previous time step.
+/// and keep track of component states from the previous time step. The north
+/// and south boundaries are periodic, so the top padded row mirrors the last
+/// unpadded row and the bottom padded row mirrors the first unpadded row.
 ///
 /// @param [in,out] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 /// @param [in] cells_per_row The number of columns there are per row in the
 ///   padded grid.
 void refresh_padded_states(Entities &entities, int cells_per_row) {
-  int num_entities = entities.names_.size();
-
-  for (int id = 0; id < num_entities; id++) {
-    if (entities.locations_[id] == utilities::kCellLocationTopPad) {
-      int neighbor_id = id + cells_per_row;
-      entities.bacteria_copy_[id] = entities.bacteria_[neighbor_id];
-      entities.nutrients_copy_[id] = entities.nutrients_[neighbor_id];
-    } else if (entities.locations_[id] == utilities::kCellLocationBottomPad) {
-      int neighbor_id = id - cells_per_row;
-      entities.bacteria_copy_[id] = entities.bacteria_[neighbor_id];
-      entities.nutrients_copy_[id] = entities.nutrients_[neighbor_id];
-    }
+  // Entity ids of the first cell in the top and bottom padded rows.
+  int top_padded_row = (entities.first_unpadded_row() - 1) * cells_per_row;
+  int bottom_padded_row = (entities.last_unpadded_row() + 1) * cells_per_row;
+
+  // Row index shift between a padded row and the unpadded row it mirrors.
+  int wraparound_shift = entities.dimensions_.number_rows * cells_per_row;
+
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+#pragma omp for schedule(static)
+  for (int column = first_column; column <= last_column; column++) {
+    int top_id = top_padded_row + column;
+    entities.bacteria_copy_[top_id] = entities.bacteria_copy_[top_id + wraparound_shift];
+    entities.nutrients_copy_[top_id] =
+        entities.nutrients_copy_[top_id + wraparound_shift];
+
+    int bottom_id = bottom_padded_row + column;
+    entities.bacteria_copy_[bottom_id] =
+        entities.bacteria_copy_[bottom_id - wraparound_shift];
+    entities.nutrients_copy_[bottom_id] =
+        entities.nutrients_copy_[bottom_id - wraparound_shift];
   }
 }
 
-/// Copy from bacteria component into bacteria_copy component.
+/// Refresh values of padded (ghost) nutrients that wrap around grid.
 ///
-/// Copying is used to keep track of bacteria component state from previous time
-/// step.
+/// Used between diffusion substeps, when only the nutrients have changed.
 ///
 /// @param [in,out] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
-void copy_bacteria_states(Entities &entities) {
-  int num_entities = entities.names_.size();
-  uint32_t transform_flag = Entities::kFlagBacteria | Entities::kFlagBacteriaCopy;
-
-  for (int id = 0; id < num_entities; id++) {
-    uint32_t flag_check = transform_flag & entities.flags_[id];
-    if (flag_check == transform_flag) {
-      entities.bacteria_copy_[id] = entities.bacteria_[id];
-    }
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+void refresh_padded_nutrients(Entities &entities, int cells_per_row) {
+  int top_padded_row = (entities.first_unpadded_row() - 1) * cells_per_row;
+  int bottom_padded_row = (entities.last_unpadded_row() + 1) * cells_per_row;
+  int wraparound_shift = entities.dimensions_.number_rows * cells_per_row;
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+#pragma omp for schedule(static)
+  for (int column = first_column; column <= last_column; column++) {
+    int top_id = top_padded_row + column;
+    entities.nutrients_copy_[top_id] =
+        entities.nutrients_copy_[top_id + wraparound_shift];
+
+    int bottom_id = bottom_padded_row + column;
+    entities.nutrients_copy_[bottom_id] =
+        entities.nutrients_copy_[bottom_id - wraparound_shift];
   }
 }
 
-/// Copy from nutrients component into nutrients_copy component.
+/// Pack eight bacteria states into eight bits, one bit per state that equals a
+/// given state.
+///
+/// States only use the two lowest bits of each byte, so a byte matches when
+/// neither bit differs. Multiplying by 0x0102040810204080 then gathers the
+/// lowest bit of each byte into the top byte.
+///
+/// @param [in] states Eight bacteria states, the first state in the lowest
+///   byte.
+/// @param [in] state State to match.
+/// @return Byte with bit i set when state i matches.
+static uint64_t pack_matching_states(uint64_t states, data::BacteriumState state) {
+  uint64_t difference = states ^ (0x0101010101010101u * state);
+  uint64_t matches = ~(difference | (difference >> 1u)) & 0x0101010101010101u;
+
+  return (matches * 0x0102040810204080u) >> 56u;
+}
+
+/// Pack the bacteria_copy component into the empty and live cell bitboards.
 ///
-/// Copying is used to keep track of nutients component state from previous time
-/// step.
+/// The padded rows are packed too, so the bitboards see the same north and
+/// south boundaries as the bacteria_copy component. Must run after the padded
+/// states are refreshed or exchanged.
 ///
 /// @param [in,out] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
-void copy_nutrients_states(Entities &entities) {
-  int num_entities = entities.names_.size();
-  uint32_t transform_flag = Entities::kFlagNutrients | Entities::kFlagNutrientsCopy;
-
-  for (int id = 0; id < num_entities; id++) {
-    uint32_t flag_check = transform_flag & entities.flags_[id];
-    if (flag_check == transform_flag) {
-      entities.nutrients_copy_[id] = entities.nutrients_[id];
+void refresh_bitboards(Entities &entities) {
+  int cells_per_row = entities.cells_per_row();
+  int words_per_row = entities.words_per_row();
+  int num_rows = entities.size() / cells_per_row;
+
+#pragma omp for schedule(static)
+  for (int row = 0; row < num_rows; row++) {
+    const data::BacteriumState *states = &entities.bacteria_copy_[row * cells_per_row];
+
+    for (int word = 0; word < words_per_row; word++) {
+      int first_column = 64 * word;
+      int num_columns = std::min(64, cells_per_row - first_column);
+
+      uint64_t empty = 0u;
+      uint64_t live = 0u;
+      for (int column = 0; column < num_columns; column += 8) {
+        // Unused bytes of a partial group are masked off below.
+        uint64_t group = 0u;
+        std::memcpy(
+            &group, &states[first_column + column],
+            std::min(8, num_columns - column) * sizeof(data::BacteriumState));
+        empty |= pack_matching_states(group, Entities::kStateEmpty) << column;
+        live |= pack_matching_states(group, Entities::kStateBacterium) << column;
+      }
+
+      uint64_t column_mask = (num_columns == 64) ? ~0ull : (1ull << num_columns) - 1u;
+      entities.empty_cells_[row * words_per_row + word] = empty & column_mask;
+      entities.live_cells_[row * words_per_row + word] = live & column_mask;
     }
   }
 }
+
+/// Swap the bacteria and nutrients components with their copies.
+///
+/// The components are double buffered. Swapping turns the states computed
+/// during the last step into the copies read during this step, without
+/// copying any values. The growth and diffusion phases then overwrite every
+/// unpadded cell of the bacteria and nutrients components, so the stale
+/// values left there by the swap are never read. Padded cells hold the same
+/// boundary values in both buffers.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void swap_states(Entities &entities) {
+#pragma omp single
+  {
+    entities.bacteria_.swap(entities.bacteria_copy_);
+    entities.nutrients_.swap(entities.nutrients_copy_);
+  }
+}
+
+/// Swap the nutrients component with its copy.
+///
+/// Used between diffusion substeps, so the nutrients computed by the last
+/// substep become the copy read by the next one.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void swap_nutrients(Entities &entities) {
+#pragma omp single
+  entities.nutrients_.swap(entities.nutrients_copy_);
+}
 }   // namespace transformers
@@ -1,12 +1,19 @@
 #ifndef BIOFILM_SIMULATION_COPY_SYSTEM_HPP
 #define BIOFILM_SIMULATION_COPY_SYSTEM_HPP
 
+#include <mpi.h>
+
 #include <entities.hpp>
 
 namespace transformers {
 void refresh_padded_states(Entities &entities, int cells_per_row);
-void copy_bacteria_states(Entities &entities);
-void copy_nutrients_states(Entities &entities);
+void exchange_padded_states(Entities &entities, int cells_per_row, MPI_Comm comm);
+void refresh_padded_nutrients(Entities &entities, int cells_per_row);
+void exchange_padded_nutrients(Entities &entities, int cells_per_row, MPI_Comm comm);
+void exchange_padded_divisions(Entities &entities, int cells_per_row, MPI_Comm comm);
+void refresh_bitboards(Entities &entities);
+void swap_states(Entities &entities);
+void swap_nutrients(Entities &entities);
 }   // namespace transformers
 
 #endif   // BIOFILM_SIMULATION_COPY_SYSTEM_HPP
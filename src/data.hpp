@@ -2,15 +2,32 @@
 #define BIOFILM_SIMULATION_DATA_HPP
 
 #include <array>
+#include <cstdint>
+#include <vector>
+
+#include <phase_timers.hpp>
 
 namespace data {
+/// Scalar type stored in the bacteria component.
+using BacteriumState = uint8_t;
+
+/// Scalar type stored in the nutrients component, selected at build time with
+/// the BIOFILM_SINGLE_PRECISION option. BIOFILM_MPI_NUTRIENT is the matching MPI
+/// datatype.
+#ifdef BIOFILM_SINGLE_PRECISION
+using Nutrient = float;
+#define BIOFILM_MPI_NUTRIENT MPI_FLOAT
+#else
+using Nutrient = double;
+#define BIOFILM_MPI_NUTRIENT MPI_DOUBLE
+#endif
+
 /// Aliases for neighbor id vectors
-using ThreeNeighborIDs = std::array<int, 3>;
 using FourNeighborIDs = std::array<int, 4>;
 using EightNeighborIDs = std::array<int, 8>;
 
 /// Alias for nutrients values vector
-using EightNutrients = std::array<double, 8>;
+using EightNutrients = std::array<Nutrient, 8>;
 
 /// Data container for indices component
 struct Index {
@@ -43,6 +60,7 @@ struct CellLocationParameters {
 struct EntityInitializationParameters {
   Index index;         ///< Row and column index of new entity.
   int cell_location;   ///< Location of new entity.
+  int cell_id;         ///< Cell id of new entity in regular, unpadded grid.
 };
 
 /// Data container of parameters used to initialize all entities in simulation.
@@ -51,26 +69,233 @@ struct InitializationParameters {
   double probability_bacterium;   ///< Probability to create a bacterium in first
                                   ///< column in the regular, unpadded grid.
   double max_nutrient;            ///< Initial fill value for nutrients component
+  bool with_metadata;             ///< Fill in the names, indices, locations, and
+                                  ///< flags components used by the debugging
+                                  ///< helpers.
 };
 
 /// Data container with parameters used for finding neighboring sites.
 struct GetNeighborsParameters {
-  int cells_per_row;        ///< The number of columns there are per row in the padded
-                            ///< grid.
-  int first_unpadded_row;   ///< Row index of the first row in the regular,
-                            ///< unpadded grid.
-  int last_unpadded_row;    ///< Row index of the last row in the regular, unpadded
-                            ///< grid.
-  int wraparound_shift;     ///< Row index shift needed to go from first row to last
-                            ///< row, and vice-versa.
+  int cells_per_row;           ///< The number of columns there are per row in the
+                               ///< padded grid.
+  int first_unpadded_row;      ///< Row index of the first row in the regular,
+                               ///< unpadded grid.
+  int last_unpadded_row;       ///< Row index of the last row in the regular, unpadded
+                               ///< grid.
+  int first_unpadded_column;   ///< Column index of the first column in the regular,
+                               ///< unpadded grid.
+  int last_unpadded_column;    ///< Column index of the last column in the regular,
+                               ///< unpadded grid.
+  int wraparound_shift;        ///< Row index shift needed to go from first row to
+                               ///< last row, and vice-versa.
 };
 
 /// Data container with values needed for applying the diffusion transformation.
 struct NutrientNeighborhood {
-  double site;                ///< Nutrients value for entity at center of Moore
+  Nutrient site;              ///< Nutrients value for entity at center of Moore
                               ///< neighborhood.
   EightNutrients neighbors;   ///< Array of nutrient values in Moore neighborhood.
 };
+
+/// Data container tracking which tiles of the nutrients grid are still
+/// changing, for the dirty-tile diffusion engine.
+///
+/// The unpadded grid is split into square tiles of tile_size cells, numbered
+/// row by row (the tiles in the last row and column may be smaller). A tile is
+/// dirty when its nutrients changed during the last step, either because the
+/// diffusion phase changed them or because a live bacterium consumed some.
+struct DirtyTiles {
+  int tile_size;                  ///< Rows and columns of cells per tile.
+  int tile_rows;                  ///< Number of rows of tiles.
+  int tile_columns;               ///< Number of tiles per row.
+  std::vector<uint8_t> changed;   ///< 1 if the last diffusion phase changed
+                                  ///< the nutrients of a tile.
+  std::vector<uint8_t> dirty;     ///< 1 if the nutrients of a tile changed
+                                  ///< during the last step.
+};
+
+/// Data container holding the elimination coefficients of the tridiagonal
+/// systems solved by the implicit diffusion engine.
+///
+/// Every row solves the same system with Dirichlet ends set by the padded
+/// columns, and every column the same cyclic system, which wraps around
+/// north to south. The coefficients are constant, so the forward elimination
+/// of the Thomas algorithm only depends on the position along the row or
+/// column, and is computed once for all of them. The cyclic system is solved
+/// as a tridiagonal system plus a correction along a fixed vector
+/// (Sherman-Morrison), also computed once.
+struct ImplicitDiffusion {
+  Nutrient coupling;                        ///< Weight of each neighbor along
+                                            ///< the solve direction.
+  std::vector<Nutrient> row_upper;          ///< Eliminated upper diagonal of
+                                            ///< the row system, per column.
+  std::vector<Nutrient> row_scale;          ///< Inverse eliminated diagonal of
+                                            ///< the row system, per column.
+  std::vector<Nutrient> column_upper;       ///< Eliminated upper diagonal of
+                                            ///< the column system, per row.
+  std::vector<Nutrient> column_scale;       ///< Inverse eliminated diagonal of
+                                            ///< the column system, per row.
+  std::vector<Nutrient> column_correction;  ///< Direction of the cyclic
+                                            ///< correction, per row.
+  Nutrient correction_corner;               ///< Weight of the last row in the
+                                            ///< cyclic correction.
+  Nutrient correction_scale;                ///< Inverse denominator of the
+                                            ///< cyclic correction.
+  int batch_values;                         ///< Nutrient values per scratch
+                                            ///< buffer of a row batch.
+  std::vector<Nutrient> batches;            ///< Scratch buffers of the
+                                            ///< interleaved row batches, one
+                                            ///< per thread.
+};
+
+/// Data container holding the tile size and scratch buffers of the blocked
+/// diffusion engine.
+///
+/// Every thread owns a pair of scratch buffers, each sized for a tile of rows
+/// plus the rows it overlaps with the neighboring tiles, and swaps between
+/// them from one substep to the next.
+struct BlockedDiffusion {
+  int tile_rows;                   ///< Number of rows per tile.
+  int buffer_values;               ///< Nutrient values per scratch buffer.
+  std::vector<Nutrient> scratch;   ///< Scratch buffers, a source and target
+                                   ///< pair per thread.
+};
+
+/// Data container measuring how much the last time step changed the grid.
+struct StepChange {
+  int state_changes;            ///< Cells whose bacteria state changed.
+  int growing_bacteria;         ///< Live bacteria with an empty neighbor, which
+                                ///< may still divide.
+  double max_nutrient_change;   ///< Largest change of a cell's nutrients
+                                ///< (L-infinity norm).
+};
+
+/// Data container with the entity ids of the live bacteria, kept up to date
+/// from step to step by the frontier growth engine.
+///
+/// Cells never become empty again once occupied, so a live bacterium without
+/// an empty neighbor can never divide and stays in the interior list until it
+/// dies.
+struct ActiveCells {
+  std::vector<int> frontier;   ///< Live bacteria that may have an empty neighbor,
+                               ///< sorted by entity id.
+  std::vector<int> interior;   ///< Live bacteria without an empty neighbor.
+  std::vector<int> targets;    ///< Entity id each frontier bacterium divides into
+                               ///< during the current growth phase, -1 if none.
+  std::vector<int> births;     ///< Cells that became live bacteria during the last
+                               ///< growth phase, sorted by entity id.
+  std::vector<int> deaths;     ///< Bacteria that died during the last growth phase.
+};
+
+/// Data container splitting the frontier bacteria of one row, a range of
+/// positions in the sorted frontier list, into the bacteria in the first
+/// column, the interior columns, and the last column.
+struct FrontierRow {
+  int row;              ///< Row index of the bacteria in the padded grid.
+  int interior_begin;   ///< Position of the first bacterium in an interior
+                        ///< column, preceded by the one in the first column.
+  int interior_end;     ///< Position one past the last bacterium in an
+                        ///< interior column, followed by the one in the last
+                        ///< column.
+  int end;              ///< Position one past the last bacterium in the row.
+};
+
+/// Header at the start of a binary history file.
+///
+/// Every field has a fixed width and natural alignment, so the struct has no
+/// padding and is written to disk as is (in the host byte order). Frames follow
+/// the header, in one of two encodings:
+///
+/// * Full (0): Each frame holds an int32 step, four reserved bytes, the uint8
+///   bacteria plane padded with zeros to a multiple of 8 bytes, and the float32
+///   nutrients plane. Every frame has frame_bytes bytes.
+/// * Delta (1): Each frame holds an int32 step, a uint32 keyframe flag, and the
+///   uint64 sizes of the bacteria and nutrients deltas, followed by the deltas.
+///   The bacteria delta is the uint8 bacteria plane XORed with the previous
+///   frame's plane. The nutrients delta is the nutrients plane quantized to
+///   uint32 multiples of nutrient_tolerance, XORed with the previous frame's
+///   quantized plane. Keyframes XOR with zeros instead, so they can be decoded
+///   on their own. Each delta is stored as a list of runs, where each run is a
+///   count of zeros to skip, a count of nonzero values that follow, and the
+///   values themselves, all as LEB128 variable-length integers.
+///
+/// Planes are stored in cell id order.
+struct HistoryHeader {
+  char magic[8];                 ///< Always "BIOFILM\0".
+  uint32_t version;              ///< Format version, currently 1.
+  uint32_t header_bytes;         ///< Offset of the first frame.
+  uint32_t number_rows;          ///< Number of unpadded rows in grid.
+  uint32_t number_columns;       ///< Number of unpadded columns in grid.
+  uint64_t frame_bytes;          ///< Size of one frame, zero if frames vary in
+                                 ///< size.
+  uint32_t seed;                 ///< Random number generator seed.
+  int32_t num_steps;             ///< Total time steps of simulation.
+  int32_t diffusion_substeps;    ///< Diffusion substeps per time step.
+  uint32_t encoding;             ///< Frame encoding, 0 for full and 1 for delta.
+  double probability_bacteria;   ///< Probability to initialize bacteria.
+  double probability_divide;     ///< Probability that a bacterium divides.
+  double consume_amount;         ///< Nutrients bacteria consume per time step.
+  double diffusion_rate;         ///< Diffusion rate for nutrients.
+  double max_nutrient;           ///< Initial fill value for nutrient grid.
+  uint32_t keyframe_interval;    ///< Frames between delta keyframes.
+  uint32_t reserved;             ///< Always zero.
+  double nutrient_tolerance;     ///< Quantization step of delta nutrients.
+};
+
+/// Footer at the end of a binary history file, after the uint64 byte offsets of
+/// every frame.
+struct HistoryFooter {
+  uint64_t number_frames;   ///< Number of frames in file.
+  uint64_t index_offset;    ///< Offset of the first frame offset.
+  char magic[8];            ///< Always "BIOFIDX\0".
+};
+
+/// Header at the start of a checkpoint file.
+///
+/// The header is followed by the simulation parameters, the text state of the
+/// Mersenne Twister engine, the uint8 bacteria plane, and the nutrients plane
+/// stored at the precision of the nutrients component. Planes cover the
+/// unpadded grid in cell id order.
+struct CheckpointHeader {
+  char magic[8];                  ///< Always "BIOFCKP\0".
+  uint32_t version;               ///< Format version, currently 1.
+  uint32_t nutrient_bytes;        ///< Size of one nutrients value.
+  int32_t step;                   ///< Number of time steps completed.
+  int32_t number_rows;            ///< Number of unpadded rows in grid.
+  int32_t number_columns;         ///< Number of unpadded columns in grid.
+  uint32_t parameters_bytes;      ///< Size of the simulation parameters.
+  uint32_t random_engine_bytes;   ///< Size of the Mersenne Twister state.
+  uint32_t reserved;              ///< Always zero.
+};
+
+/// Data container with the previous frame of a delta encoded history file.
+struct HistoryDeltaState {
+  std::vector<BacteriumState> bacteria;   ///< Bacteria states of previous frame.
+  std::vector<uint32_t> nutrients;        ///< Quantized nutrients of previous
+                                          ///< frame.
+  int number_frames;                      ///< Number of frames saved so far.
+};
+
+/// Data container with the timings of a finished simulation.
+struct SimulationResults {
+  bool completed;                          ///< False if the simulation could not
+                                           ///< start, e.g. on a bad checkpoint.
+  double simulation_time;                  ///< Time step loop running time, in
+                                           ///< seconds.
+  double history_stall_time;               ///< Time spent waiting to save the
+                                           ///< history, in seconds.
+  utilities::PhaseTimers phase_timers;     ///< Time spent in each phase.
+  int converged_step;                      ///< Step the grid reached a steady
+                                           ///< state, -1 if it never did.
+};
+
+/// Data container with the model parameters of one job in a parameter sweep.
+struct SweepJob {
+  uint32_t seed;               ///< Random number generator seed.
+  double probability_divide;   ///< Probability that a bacterium divides.
+  double diffusion_rate;       ///< Diffusion rate for nutrients.
+  double consume_amount;       ///< Nutrients bacteria consume per time step.
+};
 }   // namespace data
 
 #endif   // BIOFILM_SIMULATION_DATA_HPP
@@ -1,12 +1,162 @@
 #include <diffusion_system.hpp>
 
+#include <algorithm>
+#include <vector>
+
+#include <omp.h>
+
 #include <data.hpp>
 #include <entities.hpp>
 #include <neighbors.hpp>
 
 namespace transformers {
+/// Bytes of cache the scratch buffers of a blocked diffusion tile should fit
+/// in.
+static const int kBlockedTileBytes = 256 * 1024;
+
+/// Bytes of cache the rows of a column strip of the row-sweeping diffusion
+/// kernels should fit in.
+static const int kStripBytes = 256 * 1024;
+
+/// Rows solved together by the row sweeps of the implicit diffusion kernel.
+static const int kImplicitRowBatch = 16;
+
+/// Columns solved together by the column sweeps of the implicit diffusion
+/// kernel.
+static const int kImplicitColumnBlock = 64;
+
+/// Apply diffusion transformation to a range of columns in one row of
+/// nutrients.
+///
+/// The neighbors are summed in the same order as apply_site_diffusion.
+///
+/// @param [in] above Nutrients of the row above, including padded columns.
+/// @param [in] center Nutrients of the row, including padded columns.
+/// @param [in] below Nutrients of the row below, including padded columns.
+/// @param [out] updated Updated nutrients of the row, only the range of
+///   columns is written.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] first_column First column of the range in the padded grid.
+/// @param [in] end_column One past the last column of the range.
+static void diffuse_row_values(
+    const data::Nutrient *above, const data::Nutrient *center,
+    const data::Nutrient *below, data::Nutrient *updated, double diffusion_rate,
+    int first_column, int end_column) {
+  // Weights are converted to the nutrients component's type up front so the
+  // inner loop runs at that precision.
+  data::Nutrient site_weight = 1 - 8 * diffusion_rate;
+  data::Nutrient neighbor_weight = diffusion_rate;
+
+#pragma omp simd
+  for (int column = first_column; column < end_column; column++) {
+    data::Nutrient neighbor_sum = center[column - 1] + center[column + 1] +
+                                  above[column - 1] + above[column] + above[column + 1] +
+                                  below[column - 1] + below[column] + below[column + 1];
+    updated[column] = site_weight * center[column] + neighbor_weight * neighbor_sum;
+  }
+}
+
+/// Apply diffusion transformation to a range of columns in one row of
+/// nutrients, and check whether any value changed.
+///
+/// Computes the same values as diffuse_row_values.
+///
+/// @param [in] above Nutrients of the row above, including padded columns.
+/// @param [in] center Nutrients of the row, including padded columns.
+/// @param [in] below Nutrients of the row below, including padded columns.
+/// @param [out] updated Updated nutrients of the row, only the range of
+///   columns is written.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] first_column First column of the range in the padded grid.
+/// @param [in] end_column One past the last column of the range.
+/// @return Whether any updated value differs from the value in center.
+static bool diffuse_row_segment(
+    const data::Nutrient *above, const data::Nutrient *center,
+    const data::Nutrient *below, data::Nutrient *updated, double diffusion_rate,
+    int first_column, int end_column) {
+  data::Nutrient site_weight = 1 - 8 * diffusion_rate;
+  data::Nutrient neighbor_weight = diffusion_rate;
+  int changed = 0;
+
+#pragma omp simd reduction(| : changed)
+  for (int column = first_column; column < end_column; column++) {
+    data::Nutrient neighbor_sum = center[column - 1] + center[column + 1] +
+                                  above[column - 1] + above[column] + above[column + 1] +
+                                  below[column - 1] + below[column] + below[column + 1];
+    data::Nutrient value =
+        site_weight * center[column] + neighbor_weight * neighbor_sum;
+    changed |= (value != center[column]);
+    updated[column] = value;
+  }
+
+  return changed != 0;
+}
+
+/// Check whether a tile holds a live bacterium in the bacteria_copy component.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] dirty_tiles Tiles of the grid.
+/// @param [in] tile Index of the tile.
+/// @return Whether a live bacterium was found.
+static bool check_tile_for_live_bacteria(
+    const Entities &entities, const data::DirtyTiles &dirty_tiles, int tile) {
+  int cells_per_row = entities.cells_per_row();
+  int first_row = entities.first_unpadded_row() +
+                  (tile / dirty_tiles.tile_columns) * dirty_tiles.tile_size;
+  int end_row =
+      std::min(first_row + dirty_tiles.tile_size, entities.last_unpadded_row() + 1);
+  int first_column = entities.first_unpadded_column() +
+                     (tile % dirty_tiles.tile_columns) * dirty_tiles.tile_size;
+  int end_column =
+      std::min(first_column + dirty_tiles.tile_size, entities.last_unpadded_column() + 1);
+
+  for (int row = first_row; row < end_row; row++) {
+    const data::BacteriumState *bacteria = &entities.bacteria_copy_[row * cells_per_row];
+    int live = 0;
+
+#pragma omp simd reduction(| : live)
+    for (int column = first_column; column < end_column; column++) {
+      live |= (bacteria[column] == Entities::kStateBacterium);
+    }
+    if (live != 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/// Check whether a tile or any of the eight tiles around it is dirty.
+///
+/// The rows of tiles wrap around like the periodic north and south boundaries
+/// of the grid, while the columns of tiles end at the padded columns, whose
+/// nutrients never change.
+///
+/// @param [in] dirty_tiles Tiles of the grid.
+/// @param [in] tile Index of the tile.
+/// @return Whether a dirty tile was found.
+static bool check_tile_neighborhood(const data::DirtyTiles &dirty_tiles, int tile) {
+  int tile_row = tile / dirty_tiles.tile_columns;
+  int tile_column = tile % dirty_tiles.tile_columns;
+
+  for (int row_offset = -1; row_offset <= 1; row_offset++) {
+    int row = (tile_row + row_offset + dirty_tiles.tile_rows) % dirty_tiles.tile_rows;
+    for (int column = std::max(tile_column - 1, 0);
+         column <= std::min(tile_column + 1, dirty_tiles.tile_columns - 1); column++) {
+      if (dirty_tiles.dirty[row * dirty_tiles.tile_columns + column]) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 /// Apply diffusion transformation to nutrients component of all entities.
 ///
+/// Wide grids are swept in column strips, see get_strip_columns.
+///
 /// @param [in,out] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 /// @param [in] diffusion_rate Diffusion rate for nutrients.
@@ -15,50 +165,455 @@ namespace transformers {
 void apply_diffusion_transformation(
     Entities &entities, double diffusion_rate,
     const data::GetNeighborsParameters &get_neighbors_parameters) {
-  // Count number of entities in simulation.
-  int num_entities = entities.names_.size();
-
-  // Mask: nutrients and nutrients_copy components are active
-  uint32_t transform_flag = Entities::kFlagNutrients | Entities::kFlagNutrientsCopy;
-
-  // Loop over all entities regardless of active components.
-  for (Entities::EntityID id = 0; id < num_entities; id++) {
-    // Check if current entity's nutrients and nutrients_copy components are
-    // active
-    uint32_t flag_check = transform_flag & entities.flags_[id];
-    if (flag_check == transform_flag) {
-      // If active, find entity ids of neighboring cells
-      data::EightNeighborIDs neighbor_ids =
-          neighbors::get_nutrient_neighbor_ids(id, entities, get_neighbors_parameters);
-
-      // Package input data for diffusion transformation
-      data::NutrientNeighborhood nutrient_neighborhood{};
-      nutrient_neighborhood.site = entities.nutrients_copy_[id];
-      nutrient_neighborhood.neighbors =
-          neighbors::get_nutrient_neighbor_values(entities, neighbor_ids);
-
-      // Apply transform and update nutrients component.
-      entities.nutrients_[id] =
-          apply_site_diffusion(diffusion_rate, nutrient_neighborhood);
+  // Bounds of the regular, unpadded grid.
+  int cells_per_row = entities.cells_per_row();
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+  int first_column = entities.first_unpadded_column();
+  int number_columns = entities.dimensions_.number_columns;
+  int strip_columns = get_strip_columns(number_columns, sizeof(data::Nutrient));
+  int number_strips = (number_columns + strip_columns - 1) / strip_columns;
+
+  // Loop over the entities in the unpadded grid, whose nutrients and
+  // nutrients_copy components are always active, one column strip at a time.
+#pragma omp for collapse(2) schedule(static)
+  for (int strip = 0; strip < number_strips; strip++) {
+    for (int row = first_row; row <= last_row; row++) {
+      int strip_first_column = first_column + strip * strip_columns;
+      int strip_end_column =
+          std::min(strip_first_column + strip_columns, first_column + number_columns);
+      for (int column = strip_first_column; column < strip_end_column; column++) {
+        Entities::EntityID id = row * cells_per_row + column;
+
+        // Find entity ids of neighboring cells
+        data::EightNeighborIDs neighbor_ids =
+            neighbors::get_nutrient_neighbor_ids(id, entities, get_neighbors_parameters);
+
+        // Package input data for diffusion transformation
+        data::NutrientNeighborhood nutrient_neighborhood{};
+        nutrient_neighborhood.site = entities.nutrients_copy_[id];
+        nutrient_neighborhood.neighbors =
+            neighbors::get_nutrient_neighbor_values(entities, neighbor_ids);
+
+        // Apply transform and update nutrients component.
+        entities.nutrients_[id] =
+            apply_site_diffusion(diffusion_rate, nutrient_neighborhood);
+      }
+    }
+  }
+}
+
+/// Apply diffusion transformation to nutrients component one row at a time.
+///
+/// Sweeps the unpadded grid row by row, reading the rows above and below
+/// straight from the padded grid. The north and south boundaries come from the
+/// padded rows, so they must be refreshed (or exchanged) beforehand and no cell
+/// needs the wraparound shift. Each row is a contiguous range of entities, so
+/// the inner loop is vectorized. The neighbors are summed in the same order as
+/// apply_site_diffusion, so both versions give identical results. Wide grids
+/// are swept in column strips, see get_strip_columns.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+void apply_row_diffusion_transformation(
+    Entities &entities, double diffusion_rate, int cells_per_row) {
+  // Count number of padded rows in simulation.
+  int num_rows = entities.size() / cells_per_row;
+
+  // Count number of unpadded columns per strip.
+  int strip_columns = get_strip_columns(cells_per_row - 2, sizeof(data::Nutrient));
+  int number_strips = (cells_per_row - 2 + strip_columns - 1) / strip_columns;
+
+  // Loop over unpadded rows, skipping the padded rows at the top and bottom,
+  // one column strip at a time.
+#pragma omp for collapse(2) schedule(static)
+  for (int strip = 0; strip < number_strips; strip++) {
+    for (int row = 1; row < num_rows - 1; row++) {
+      int first_column = 1 + strip * strip_columns;
+      int end_column = std::min(first_column + strip_columns, cells_per_row - 1);
+      diffuse_row_values(
+          &entities.nutrients_copy_[(row - 1) * cells_per_row],
+          &entities.nutrients_copy_[row * cells_per_row],
+          &entities.nutrients_copy_[(row + 1) * cells_per_row],
+          &entities.nutrients_[row * cells_per_row], diffusion_rate, first_column,
+          end_column);
+    }
+  }
+}
+
+/// Apply diffusion transformation to the nutrients component of one unpadded
+/// row.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+void diffuse_row(Entities &entities, double diffusion_rate, int row) {
+  int cells_per_row = entities.cells_per_row();
+
+  diffuse_row_values(
+      &entities.nutrients_copy_[(row - 1) * cells_per_row],
+      &entities.nutrients_copy_[row * cells_per_row],
+      &entities.nutrients_copy_[(row + 1) * cells_per_row],
+      &entities.nutrients_[row * cells_per_row], diffusion_rate, 1, cells_per_row - 1);
+}
+
+/// Apply diffusion transformation to the nutrients component, skipping the
+/// tiles whose neighborhood stopped changing.
+///
+/// Gives the same result as the row diffusion kernel with one substep. A tile
+/// is dirty when the last diffusion phase changed its nutrients or it held a
+/// live bacterium after the last growth phase, since only live bacteria
+/// consume nutrients. When neither a tile nor any tile around it is dirty,
+/// this step's diffusion reads the same nutrients as the last one and would
+/// compute the same values, which the nutrients component already holds from
+/// two steps back. Such tiles are skipped without being written.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] dirty_tiles Tiles of the grid, updated with the tiles this
+///   diffusion phase changed.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+void apply_dirty_tile_diffusion_transformation(
+    Entities &entities, data::DirtyTiles &dirty_tiles, double diffusion_rate) {
+  int cells_per_row = entities.cells_per_row();
+  int number_tiles = dirty_tiles.tile_rows * dirty_tiles.tile_columns;
+  int tile_size = dirty_tiles.tile_size;
+
+  // Mark the tiles whose nutrients changed during the last step
+#pragma omp for schedule(static)
+  for (int tile = 0; tile < number_tiles; tile++) {
+    dirty_tiles.dirty[tile] = dirty_tiles.changed[tile] ||
+                              check_tile_for_live_bacteria(entities, dirty_tiles, tile);
+  }
+
+  // Diffuse the tiles next to a dirty tile
+#pragma omp for schedule(static)
+  for (int tile = 0; tile < number_tiles; tile++) {
+    bool changed = false;
+
+    if (check_tile_neighborhood(dirty_tiles, tile)) {
+      int first_row =
+          entities.first_unpadded_row() + (tile / dirty_tiles.tile_columns) * tile_size;
+      int end_row = std::min(first_row + tile_size, entities.last_unpadded_row() + 1);
+      int first_column = entities.first_unpadded_column() +
+                         (tile % dirty_tiles.tile_columns) * tile_size;
+      int end_column =
+          std::min(first_column + tile_size, entities.last_unpadded_column() + 1);
+
+      for (int row = first_row; row < end_row; row++) {
+        changed |= diffuse_row_segment(
+            &entities.nutrients_copy_[(row - 1) * cells_per_row],
+            &entities.nutrients_copy_[row * cells_per_row],
+            &entities.nutrients_copy_[(row + 1) * cells_per_row],
+            &entities.nutrients_[row * cells_per_row], diffusion_rate, first_column,
+            end_column);
+      }
     }
+    dirty_tiles.changed[tile] = changed;
   }
 }
 
+/// Apply implicit diffusion transformation to the nutrients component.
+///
+/// Takes one backward Euler step along the rows and then one along the
+/// columns, which is stable at any diffusion rate. The rows solve their
+/// tridiagonal systems with the Thomas algorithm, using the padded columns as
+/// Dirichlet boundaries, in batches of rows copied into a buffer with their
+/// values interleaved. The columns, which wrap around north to south, are
+/// solved in place in blocks of adjacent columns that sweep down the rows
+/// together. Either way the inner loops run across the batch or block and
+/// vectorize.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients grid.
+/// @param [in,out] implicit_diffusion Coefficients of the tridiagonal systems
+///   and scratch buffers of the row batches.
+void apply_implicit_diffusion_transformation(
+    Entities &entities, data::ImplicitDiffusion &implicit_diffusion) {
+  int cells_per_row = entities.cells_per_row();
+  int first_row = entities.first_unpadded_row();
+  int number_rows = entities.dimensions_.number_rows;
+  int first_column = entities.first_unpadded_column();
+  int number_columns = entities.dimensions_.number_columns;
+  data::Nutrient coupling = implicit_diffusion.coupling;
+
+  // Solve along the rows, in batches of rows interleaved column by column so
+  // the eliminations of the batch's rows run side by side across the lanes
+  const std::vector<data::Nutrient> &row_upper = implicit_diffusion.row_upper;
+  const std::vector<data::Nutrient> &row_scale = implicit_diffusion.row_scale;
+  int number_batches = (number_rows + kImplicitRowBatch - 1) / kImplicitRowBatch;
+  data::Nutrient *batch = &implicit_diffusion.batches[omp_get_thread_num() *
+                                                       implicit_diffusion.batch_values];
+
+#pragma omp for schedule(static)
+  for (int index = 0; index < number_batches; index++) {
+    int batch_first_row = first_row + index * kImplicitRowBatch;
+    int batch_rows =
+        std::min(kImplicitRowBatch, first_row + number_rows - batch_first_row);
+
+    // Interleave the rows, the padded columns adding to the first and last
+    // right-hand sides. The lanes past the end of a short batch repeat its
+    // last row.
+    const data::Nutrient *previous[kImplicitRowBatch];
+    data::Nutrient *updated[kImplicitRowBatch];
+    for (int lane = 0; lane < kImplicitRowBatch; lane++) {
+      int row = batch_first_row + std::min(lane, batch_rows - 1);
+      previous[lane] = &entities.nutrients_copy_[row * cells_per_row + first_column];
+      updated[lane] = &entities.nutrients_[row * cells_per_row + first_column];
+    }
+    for (int column = 0; column < number_columns; column++) {
+      for (int lane = 0; lane < kImplicitRowBatch; lane++) {
+        batch[column * kImplicitRowBatch + lane] = previous[lane][column];
+      }
+    }
+    for (int lane = 0; lane < kImplicitRowBatch; lane++) {
+      batch[lane] += coupling * previous[lane][-1];
+      batch[(number_columns - 1) * kImplicitRowBatch + lane] +=
+          coupling * previous[lane][number_columns];
+    }
+
+    // Forward elimination
+    data::Nutrient *values = batch;
+
+#pragma omp simd
+    for (int lane = 0; lane < kImplicitRowBatch; lane++) {
+      values[lane] *= row_scale[0];
+    }
+    for (int column = 1; column < number_columns; column++) {
+      data::Nutrient *current = values + column * kImplicitRowBatch;
+      data::Nutrient scale = row_scale[column];
+
+#pragma omp simd
+      for (int lane = 0; lane < kImplicitRowBatch; lane++) {
+        current[lane] =
+            (current[lane] + coupling * current[lane - kImplicitRowBatch]) * scale;
+      }
+    }
+
+    // Back substitution
+    for (int column = number_columns - 2; column >= 0; column--) {
+      data::Nutrient *current = values + column * kImplicitRowBatch;
+      data::Nutrient upper = row_upper[column];
+
+#pragma omp simd
+      for (int lane = 0; lane < kImplicitRowBatch; lane++) {
+        current[lane] -= upper * current[lane + kImplicitRowBatch];
+      }
+    }
+
+    for (int column = 0; column < number_columns; column++) {
+      for (int lane = 0; lane < batch_rows; lane++) {
+        updated[lane][column] = batch[column * kImplicitRowBatch + lane];
+      }
+    }
+  }
+
+  // A single row is its own north and south neighbor, so the column solve
+  // leaves it unchanged
+  if (number_rows == 1) {
+    return;
+  }
+
+  // Solve along the columns, one block of columns at a time
+  int number_blocks = (number_columns + kImplicitColumnBlock - 1) / kImplicitColumnBlock;
+  const std::vector<data::Nutrient> &column_upper = implicit_diffusion.column_upper;
+  const std::vector<data::Nutrient> &column_scale = implicit_diffusion.column_scale;
+  const std::vector<data::Nutrient> &correction = implicit_diffusion.column_correction;
+
+#pragma omp for schedule(static)
+  for (int block = 0; block < number_blocks; block++) {
+    int begin_column = first_column + block * kImplicitColumnBlock;
+    int end_column =
+        std::min(begin_column + kImplicitColumnBlock, first_column + number_columns);
+    data::Nutrient *first = &entities.nutrients_[first_row * cells_per_row];
+    data::Nutrient *last =
+        &entities.nutrients_[(first_row + number_rows - 1) * cells_per_row];
+
+    // Forward elimination
+#pragma omp simd
+    for (int column = begin_column; column < end_column; column++) {
+      first[column] *= column_scale[0];
+    }
+    for (int index = 1; index < number_rows; index++) {
+      data::Nutrient *current = first + index * cells_per_row;
+      const data::Nutrient *above = current - cells_per_row;
+      data::Nutrient scale = column_scale[index];
+
+#pragma omp simd
+      for (int column = begin_column; column < end_column; column++) {
+        current[column] = (current[column] + coupling * above[column]) * scale;
+      }
+    }
+
+    // Back substitution
+    for (int index = number_rows - 2; index >= 0; index--) {
+      data::Nutrient *current = first + index * cells_per_row;
+      const data::Nutrient *below = current + cells_per_row;
+      data::Nutrient upper = column_upper[index];
+
+#pragma omp simd
+      for (int column = begin_column; column < end_column; column++) {
+        current[column] -= upper * below[column];
+      }
+    }
+
+    // Cyclic correction coupling the first and last rows
+    data::Nutrient factors[kImplicitColumnBlock];
+
+#pragma omp simd
+    for (int column = begin_column; column < end_column; column++) {
+      factors[column - begin_column] =
+          (first[column] + implicit_diffusion.correction_corner * last[column]) *
+          implicit_diffusion.correction_scale;
+    }
+    for (int index = 0; index < number_rows; index++) {
+      data::Nutrient *current = first + index * cells_per_row;
+      data::Nutrient direction = correction[index];
+
+#pragma omp simd
+      for (int column = begin_column; column < end_column; column++) {
+        current[column] -= factors[column - begin_column] * direction;
+      }
+    }
+  }
+}
+
+/// Apply several diffusion substeps to the nutrients component, advancing one
+/// tile of rows through all substeps while it is in cache.
+///
+/// Gives the same result as applying the row diffusion kernel once per
+/// substep, refreshing the padded rows in between. Each tile is copied into a
+/// pair of scratch buffers together with the substeps rows on either side of
+/// it, wrapping around the periodic north and south boundaries. Every substep
+/// then shrinks the valid rows by one at each end (trapezoid tiling), so after
+/// the last substep exactly the tile's own rows are valid. The padded columns
+/// are copied along with the rows and never change. The nutrients_copy
+/// component must hold the nutrients from the previous step, and is left
+/// unchanged.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] blocked_diffusion Tile size and scratch buffers of the
+///   blocked diffusion engine.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] substeps Number of diffusion substeps per time step.
+void apply_blocked_diffusion_transformation(
+    Entities &entities, data::BlockedDiffusion &blocked_diffusion,
+    double diffusion_rate, int substeps) {
+  int cells_per_row = entities.cells_per_row();
+  int number_rows = entities.dimensions_.number_rows;
+  int first_row = entities.first_unpadded_row();
+  int tile_rows = blocked_diffusion.tile_rows;
+  int num_tiles = (number_rows + tile_rows - 1) / tile_rows;
+
+  // Each thread works in its own pair of scratch buffers
+  data::Nutrient *source = &blocked_diffusion.scratch[2 * omp_get_thread_num() *
+                                                      blocked_diffusion.buffer_values];
+  data::Nutrient *target = source + blocked_diffusion.buffer_values;
+
+#pragma omp for schedule(static)
+  for (int tile = 0; tile < num_tiles; tile++) {
+    int tile_first = tile * tile_rows;
+    int tile_size = std::min(tile_rows, number_rows - tile_first);
+    int loaded_rows = tile_size + 2 * substeps;
+
+    // Load the tile and its overlap, counting rows from zero in the unpadded
+    // grid so the periodic wrap is a modulo.
+    for (int i = 0; i < loaded_rows; i++) {
+      int row = ((tile_first - substeps + i) % number_rows + number_rows) % number_rows;
+      const data::Nutrient *loaded =
+          &entities.nutrients_copy_[(first_row + row) * cells_per_row];
+      std::copy(loaded, loaded + cells_per_row, &source[i * cells_per_row]);
+      std::copy(loaded, loaded + cells_per_row, &target[i * cells_per_row]);
+    }
+
+    for (int substep = 1; substep <= substeps; substep++) {
+      for (int i = substep; i < loaded_rows - substep; i++) {
+        diffuse_row_values(
+            &source[(i - 1) * cells_per_row], &source[i * cells_per_row],
+            &source[(i + 1) * cells_per_row], &target[i * cells_per_row],
+            diffusion_rate, 1, cells_per_row - 1);
+      }
+      std::swap(source, target);
+    }
+
+    // Store the rows that went through every substep.
+    for (int i = 0; i < tile_size; i++) {
+      const data::Nutrient *stored = &source[(substeps + i) * cells_per_row];
+      std::copy(
+          stored + 1, stored + cells_per_row - 1,
+          &entities.nutrients_[(first_row + tile_first + i) * cells_per_row + 1]);
+    }
+  }
+}
+
+/// Number of rows per tile in the blocked diffusion engine.
+///
+/// Two scratch buffers of a tile and its overlap should fit in the cache
+/// budget. The tile is kept at least four times as tall as its overlap on
+/// each side, so at most half the rows diffused are recomputed by the
+/// neighboring tiles.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] substeps Number of diffusion substeps per time step.
+/// @return Number of rows per tile.
+int get_blocked_tile_rows(const Entities &entities, int substeps) {
+  int bytes_per_row = 2 * entities.cells_per_row() * sizeof(data::Nutrient);
+  int tile_rows =
+      std::max(kBlockedTileBytes / bytes_per_row - 2 * substeps, 4 * substeps);
+
+  return std::min(tile_rows, entities.dimensions_.number_rows);
+}
+
+/// Number of nutrient values in the scratch buffer of one row batch of the
+/// implicit diffusion engine.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @return Number of values per scratch buffer.
+int get_implicit_batch_values(const Entities &entities) {
+  return entities.dimensions_.number_columns * kImplicitRowBatch;
+}
+
+/// Number of unpadded columns per strip of the row-sweeping diffusion kernels.
+///
+/// The row-sweeping kernels split the grid into strips of adjacent columns
+/// and sweep each strip from top to bottom. The strip's share of the three rows
+/// read and the row written fits in the cache budget, so the rows above and
+/// below a row are still in cache when it is diffused, however wide the grid.
+/// Narrower grids are swept in one strip of whole rows.
+///
+/// @param [in] number_columns Number of unpadded columns in the grid.
+/// @param [in] bytes_per_column Bytes of nutrients per column of one row.
+/// @return Number of columns per strip.
+int get_strip_columns(int number_columns, int bytes_per_column) {
+  int strip_columns = kStripBytes / (4 * bytes_per_column);
+
+  return std::max(1, std::min(strip_columns, number_columns));
+}
+
 /// Diffuses nutrients using a Moore neighborhood.
 ///
 /// @param [in] diffusion_rate Diffusion rate for nutrients.
 /// @param [in] neighborhood Nutrient values of neighboring cells.
 /// @return Updated nutrients value after diffusion.
-double
+data::Nutrient
 apply_site_diffusion(double diffusion_rate, data::NutrientNeighborhood &neighborhood) {
-  double site = neighborhood.site;
+  data::Nutrient site = neighborhood.site;
   data::EightNutrients neighbors = neighborhood.neighbors;
+  data::Nutrient site_weight = 1 - 8 * diffusion_rate;
+  data::Nutrient neighbor_weight = diffusion_rate;
 
-  double neighbor_sum = 0.0;
+  data::Nutrient neighbor_sum = 0.0;
   for (int i = 0; i < 8; i++) {
     neighbor_sum += neighbors[i];
   }
 
-  return (1 - 8 * diffusion_rate) * site + diffusion_rate * neighbor_sum;
+  return site_weight * site + neighbor_weight * neighbor_sum;
 }
 }   // namespace transformers
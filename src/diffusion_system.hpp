@@ -2,13 +2,27 @@
 #define BIOFILM_SIMULATION_DIFFUSION_SYSTEM_HPP
 
 #include <data.hpp>
+#include <entities.hpp>
 #include <utilities.hpp>
 
 namespace transformers {
 void apply_diffusion_transformation(
     Entities &entities, double diffusion_rate,
     const data::GetNeighborsParameters &get_neighbors_parameters);
-double
+void apply_row_diffusion_transformation(
+    Entities &entities, double diffusion_rate, int cells_per_row);
+void diffuse_row(Entities &entities, double diffusion_rate, int row);
+void apply_dirty_tile_diffusion_transformation(
+    Entities &entities, data::DirtyTiles &dirty_tiles, double diffusion_rate);
+void apply_implicit_diffusion_transformation(
+    Entities &entities, data::ImplicitDiffusion &implicit_diffusion);
+void apply_blocked_diffusion_transformation(
+    Entities &entities, data::BlockedDiffusion &blocked_diffusion,
+    double diffusion_rate, int substeps);
+int get_blocked_tile_rows(const Entities &entities, int substeps);
+int get_implicit_batch_values(const Entities &entities);
+int get_strip_columns(int number_columns, int bytes_per_column);
+data::Nutrient
 apply_site_diffusion(double diffusion_rate, data::NutrientNeighborhood &neighborhood);
 }   // namespace transformers
 
@@ -0,0 +1,98 @@
+#ifndef BIOFILM_SIMULATION_ENSEMBLE_ENTITIES_HPP
+#define BIOFILM_SIMULATION_ENSEMBLE_ENTITIES_HPP
+
+#include <components.hpp>
+#include <data.hpp>
+
+/// Manages several replicas of the simulation grid, interleaved per cell.
+///
+/// Every entity of the padded grid holds one value per replica (lane) in each
+/// component, stored next to each other, so the component value of lane l of
+/// entity id is at index id * lanes_ + l. A row of the grid is then a
+/// contiguous range of cells_per_row() * lanes_ values, and the east and west
+/// neighbors of a value are lanes_ values away. Loops over a row that do the
+/// same thing in every lane vectorize across replicas, even when the grid is
+/// too narrow to fill the vector units with one replica. The growth and
+/// consumption phases find the live bacteria and empty cells through one bit
+/// mask of lanes per entity and a bitboard of the entities where any lane
+/// lives, kept up to date as the bacteria states change, so they only visit
+/// the entities where something lives. At most 64 replicas fit in an
+/// ensemble.
+struct EnsembleEntities {
+  data::Dimensions dimensions_;           ///< Dimensions of the grid every
+                                          ///< replica is laid out on.
+                                          ///<
+  int lanes_ = 0;                         ///< Number of replicas.
+                                          ///<
+  component::Bacteria bacteria_;          ///< The bacteria grid states of
+                                          ///< every replica.
+                                          ///<
+  component::Nutrients nutrients_;        ///< The nutrients grid states of
+                                          ///< every replica.
+                                          ///<
+  component::Bacteria bacteria_copy_;     ///< The bacteria_copy grid states of
+                                          ///< every replica.
+                                          ///<
+  component::Nutrients nutrients_copy_;   ///< The nutrients_copy grid states of
+                                          ///< every replica.
+                                          ///<
+  component::Bitboard live_lanes_;        ///< Lanes of each entity holding a
+                                          ///< live bacterium in bacteria, bit l
+                                          ///< for lane l.
+                                          ///<
+  component::Bitboard empty_lanes_;       ///< Lanes of each entity holding an
+                                          ///< empty cell in bacteria.
+                                          ///<
+  component::Bitboard birth_lanes_;       ///< Lanes of each entity a bacterium
+                                          ///< divides into during the current
+                                          ///< growth phase.
+                                          ///<
+  component::Bitboard live_cells_;        ///< One bit per entity, set when any
+                                          ///< lane holds a live bacterium. Each
+                                          ///< row is padded to whole 64-bit
+                                          ///< words.
+                                          ///<
+  component::Bitboard birth_cells_;       ///< One bit per entity, set when any
+                                          ///< lane receives a division during
+                                          ///< the current growth phase.
+
+  /// Count the entities of one replica, including the padded cells.
+  ///
+  /// @return The number of entities.
+  int size() const { return bacteria_.size() / lanes_; }
+
+  /// Count the columns per row in the padded grid.
+  ///
+  /// @return The number of columns there are per row in the padded grid.
+  int cells_per_row() const {
+    return dimensions_.number_columns + 2 * dimensions_.size_padding;
+  }
+
+  /// Count the 64-bit words per row in the bitboard components.
+  ///
+  /// @return The number of words there are per row in the bitboards.
+  int words_per_row() const { return (cells_per_row() + 63) / 64; }
+
+  /// Count the component values per row in the padded grid, one per lane.
+  ///
+  /// @return The number of values there are per row in the padded grid.
+  int values_per_row() const { return cells_per_row() * lanes_; }
+
+  /// Row index of the first row in the regular, unpadded grid.
+  int first_unpadded_row() const { return dimensions_.size_padding; }
+
+  /// Row index of the last row in the regular, unpadded grid.
+  int last_unpadded_row() const {
+    return dimensions_.size_padding + dimensions_.number_rows - 1;
+  }
+
+  /// Column index of the first column in the regular, unpadded grid.
+  int first_unpadded_column() const { return dimensions_.size_padding; }
+
+  /// Column index of the last column in the regular, unpadded grid.
+  int last_unpadded_column() const {
+    return dimensions_.size_padding + dimensions_.number_columns - 1;
+  }
+};
+
+#endif   // BIOFILM_SIMULATION_ENSEMBLE_ENTITIES_HPP
@@ -0,0 +1,492 @@
+#include <ensemble_system.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <data.hpp>
+#include <diffusion_system.hpp>
+#include <ensemble_entities.hpp>
+#include <entities.hpp>
+#include <neighbors.hpp>
+
+namespace transformers {
+/// Get ids for von Neumann neighborhood for an entity on the 2D grid.
+///
+/// Same neighborhood as neighbors::get_bacterium_neighbors, shared by every
+/// lane of the entity.
+///
+/// @param [in] id Identifies entity whose neighbors you want to find.
+/// @param [in] row Row index of the entity in the padded grid.
+/// @param [in] parameters Input data used for finding neighboring sites.
+/// @return Array of entity ids in von Neumann neighborhood, in the order west,
+///   east, north, south.
+static data::FourNeighborIDs
+get_ensemble_neighbors(int id, int row, const data::GetNeighborsParameters &parameters) {
+  int top_neighbor = (row == parameters.first_unpadded_row)
+                         ? id + parameters.wraparound_shift
+                         : id - parameters.cells_per_row;
+  int bottom_neighbor = (row == parameters.last_unpadded_row)
+                            ? id - parameters.wraparound_shift
+                            : id + parameters.cells_per_row;
+
+  return data::FourNeighborIDs{{id - 1, id + 1, top_neighbor, bottom_neighbor}};
+}
+
+/// Find the lanes of an entity holding a live bacterium with at least one
+/// empty neighbor.
+///
+/// The lane masks of the padded columns are zero, so the west neighbor of the
+/// first column and the east neighbor of the last column are never empty.
+///
+/// @param [in] ensemble EnsembleEntities struct with components defining the
+///   nutrients and bacteria grids of every replica.
+/// @param [in] id Identifies the entity.
+/// @param [in] neighborhood Entity ids in von Neumann neighborhood.
+/// @return Mask with bit l set for every such lane l.
+static uint64_t get_ensemble_dividing_lanes(
+    const EnsembleEntities &ensemble, int id, const data::FourNeighborIDs &neighborhood) {
+  uint64_t empty_neighbor_lanes = 0u;
+  for (int slot = 0; slot < 4; slot++) {
+    empty_neighbor_lanes |= ensemble.empty_lanes_[neighborhood[slot]];
+  }
+
+  return ensemble.live_lanes_[id] & empty_neighbor_lanes;
+}
+
+/// Read the empty neighbors of one lane of an entity.
+///
+/// @param [in] ensemble EnsembleEntities struct with components defining the
+///   nutrients and bacteria grids of every replica.
+/// @param [in] neighborhood Entity ids in von Neumann neighborhood.
+/// @param [in] lane Replica to check.
+/// @return 4-bit mask with bit 0 set for an empty west neighbor, bit 1 for
+///   east, bit 2 for north, and bit 3 for south.
+static int get_ensemble_empty_neighbor_mask(
+    const EnsembleEntities &ensemble, const data::FourNeighborIDs &neighborhood,
+    int lane) {
+  int mask = 0;
+  for (int slot = 0; slot < 4; slot++) {
+    mask |= static_cast<int>((ensemble.empty_lanes_[neighborhood[slot]] >> lane) & 1u)
+            << slot;
+  }
+
+  return mask;
+}
+
+/// Find the neighbor of the n-th set bit of an empty-neighbor mask.
+///
+/// Set bits are counted in slot order, the order collect_empty_neighbors lists
+/// the empty neighbors, so the pick matches neighbors::pick_bacterium_neighbor.
+///
+/// @param [in] neighborhood Entity ids in von Neumann neighborhood.
+/// @param [in] mask Empty-neighbor mask.
+/// @param [in] selected_neighbor Index of the empty neighbor to pick.
+/// @return Entity id of the picked empty neighbor.
+static int get_selected_neighbor(
+    const data::FourNeighborIDs &neighborhood, int mask, int selected_neighbor) {
+  for (int slot = 0; slot < 4; slot++) {
+    if ((mask >> slot) & 1) {
+      if (selected_neighbor == 0) {
+        return neighborhood[slot];
+      }
+      selected_neighbor--;
+    }
+  }
+
+  return -1;
+}
+
+/// Record that one lane of an entity receives a division.
+///
+/// The entity may be in a row proposed by another thread, so the bits are set
+/// atomically.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+/// @param [in] id Identifies the entity the bacterium divides into.
+/// @param [in] lane Replica of the dividing bacterium.
+static void record_ensemble_division(EnsembleEntities &ensemble, int id, int lane) {
+  int cells_per_row = ensemble.cells_per_row();
+  int row = id / cells_per_row;
+  int column = id % cells_per_row;
+  int word_id = row * ensemble.words_per_row() + column / 64;
+
+#pragma omp atomic
+  ensemble.birth_lanes_[id] |= 1ull << lane;
+#pragma omp atomic
+  ensemble.birth_cells_[word_id] |= 1ull << (column % 64);
+}
+
+/// Compute the new bacteria state of every lane of every cell from the
+/// proposed divisions, and update the lane masks and live cells bitboard to
+/// match.
+///
+/// Each row of states is copied over first, then only the entities holding a
+/// live bacterium or receiving a division in some lane are revisited.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+static void resolve_ensemble_divisions(EnsembleEntities &ensemble) {
+  int lanes = ensemble.lanes_;
+  int cells_per_row = ensemble.cells_per_row();
+  int words_per_row = ensemble.words_per_row();
+  int first_row = ensemble.first_unpadded_row();
+  int last_row = ensemble.last_unpadded_row();
+  int first_value = ensemble.first_unpadded_column() * lanes;
+  int end_value = (ensemble.last_unpadded_column() + 1) * lanes;
+
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    int row_start = row * cells_per_row;
+    std::copy(
+        &ensemble.bacteria_copy_[row_start * lanes + first_value],
+        &ensemble.bacteria_copy_[row_start * lanes + end_value],
+        &ensemble.bacteria_[row_start * lanes + first_value]);
+
+    for (int word = 0; word < words_per_row; word++) {
+      int word_id = row * words_per_row + word;
+      uint64_t changed = ensemble.live_cells_[word_id] | ensemble.birth_cells_[word_id];
+      uint64_t live = 0u;
+
+      while (changed != 0u) {
+        int bit = __builtin_ctzll(changed);
+        changed &= changed - 1u;
+        Entities::EntityID id = row_start + 64 * word + bit;
+        uint64_t live_lanes = ensemble.live_lanes_[id];
+        uint64_t birth_lanes = ensemble.birth_lanes_[id];
+
+        // Live bacteria die where the nutrients ran out.
+        for (uint64_t lanes_left = live_lanes; lanes_left != 0u;
+             lanes_left &= lanes_left - 1u) {
+          int lane = __builtin_ctzll(lanes_left);
+          if (ensemble.nutrients_[id * lanes + lane] < 1.0E-5) {
+            ensemble.bacteria_[id * lanes + lane] = Entities::kStateDead;
+            live_lanes &= ~(1ull << lane);
+          }
+        }
+
+        // Empty cells receiving a division become live bacteria.
+        for (uint64_t lanes_left = birth_lanes; lanes_left != 0u;
+             lanes_left &= lanes_left - 1u) {
+          ensemble.bacteria_[id * lanes + __builtin_ctzll(lanes_left)] =
+              Entities::kStateBacterium;
+        }
+
+        live_lanes |= birth_lanes;
+        ensemble.live_lanes_[id] = live_lanes;
+        ensemble.empty_lanes_[id] &= ~birth_lanes;
+        ensemble.birth_lanes_[id] = 0u;
+        if (live_lanes != 0u) {
+          live |= 1ull << bit;
+        }
+      }
+
+      ensemble.live_cells_[word_id] = live;
+      ensemble.birth_cells_[word_id] = 0u;
+    }
+  }
+}
+
+/// Swap the bacteria and nutrients components of every replica with their
+/// copies.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+void swap_ensemble_states(EnsembleEntities &ensemble) {
+#pragma omp single
+  {
+    ensemble.bacteria_.swap(ensemble.bacteria_copy_);
+    ensemble.nutrients_.swap(ensemble.nutrients_copy_);
+  }
+}
+
+/// Swap the nutrients component of every replica with its copy.
+///
+/// Used between diffusion substeps.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+void swap_ensemble_nutrients(EnsembleEntities &ensemble) {
+#pragma omp single
+  ensemble.nutrients_.swap(ensemble.nutrients_copy_);
+}
+
+/// Refresh the padded rows of the bacteria_copy and nutrients_copy components
+/// of every replica (periodic north and south boundaries).
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+void refresh_padded_ensemble_states(EnsembleEntities &ensemble) {
+  int values_per_row = ensemble.values_per_row();
+  int first_value = ensemble.first_unpadded_column() * ensemble.lanes_;
+  int end_value = (ensemble.last_unpadded_column() + 1) * ensemble.lanes_;
+  int top_padded_row = (ensemble.first_unpadded_row() - 1) * values_per_row;
+  int bottom_padded_row = (ensemble.last_unpadded_row() + 1) * values_per_row;
+  int wraparound_shift = ensemble.dimensions_.number_rows * values_per_row;
+
+  refresh_padded_ensemble_nutrients(ensemble);
+
+#pragma omp single
+  {
+    std::copy(
+        &ensemble.bacteria_copy_[top_padded_row + wraparound_shift + first_value],
+        &ensemble.bacteria_copy_[top_padded_row + wraparound_shift + end_value],
+        &ensemble.bacteria_copy_[top_padded_row + first_value]);
+    std::copy(
+        &ensemble.bacteria_copy_[bottom_padded_row - wraparound_shift + first_value],
+        &ensemble.bacteria_copy_[bottom_padded_row - wraparound_shift + end_value],
+        &ensemble.bacteria_copy_[bottom_padded_row + first_value]);
+  }
+}
+
+/// Refresh the padded rows of the nutrients_copy component of every replica
+/// (periodic north and south boundaries).
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+void refresh_padded_ensemble_nutrients(EnsembleEntities &ensemble) {
+  int values_per_row = ensemble.values_per_row();
+  int first_value = ensemble.first_unpadded_column() * ensemble.lanes_;
+  int end_value = (ensemble.last_unpadded_column() + 1) * ensemble.lanes_;
+  int top_padded_row = (ensemble.first_unpadded_row() - 1) * values_per_row;
+  int bottom_padded_row = (ensemble.last_unpadded_row() + 1) * values_per_row;
+  int wraparound_shift = ensemble.dimensions_.number_rows * values_per_row;
+
+#pragma omp single
+  {
+    std::copy(
+        &ensemble.nutrients_copy_[top_padded_row + wraparound_shift + first_value],
+        &ensemble.nutrients_copy_[top_padded_row + wraparound_shift + end_value],
+        &ensemble.nutrients_copy_[top_padded_row + first_value]);
+    std::copy(
+        &ensemble.nutrients_copy_[bottom_padded_row - wraparound_shift + first_value],
+        &ensemble.nutrients_copy_[bottom_padded_row - wraparound_shift + end_value],
+        &ensemble.nutrients_copy_[bottom_padded_row + first_value]);
+  }
+}
+
+/// Apply diffusion transformation to the nutrients component of every replica.
+///
+/// Each row is swept as one contiguous range of values, with the east and west
+/// neighbors one lane stride away, so the inner loop vectorizes across the
+/// replicas as well as the columns. The neighbors are summed in the same order
+/// as the rows kernel, so every lane gets the same result as a single replica.
+/// Wide grids are swept in column strips, like the rows kernel.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+void apply_ensemble_diffusion_transformation(
+    EnsembleEntities &ensemble, double diffusion_rate) {
+  int lanes = ensemble.lanes_;
+  int values_per_row = ensemble.values_per_row();
+  int first_row = ensemble.first_unpadded_row();
+  int last_row = ensemble.last_unpadded_row();
+  int first_column = ensemble.first_unpadded_column();
+  int number_columns = ensemble.dimensions_.number_columns;
+  int strip_columns = get_strip_columns(number_columns, lanes * sizeof(data::Nutrient));
+  int number_strips = (number_columns + strip_columns - 1) / strip_columns;
+  data::Nutrient site_weight = 1 - 8 * diffusion_rate;
+  data::Nutrient neighbor_weight = diffusion_rate;
+
+#pragma omp for collapse(2) schedule(static)
+  for (int strip = 0; strip < number_strips; strip++) {
+    for (int row = first_row; row <= last_row; row++) {
+      const data::Nutrient *above = &ensemble.nutrients_copy_[(row - 1) * values_per_row];
+      const data::Nutrient *center = &ensemble.nutrients_copy_[row * values_per_row];
+      const data::Nutrient *below = &ensemble.nutrients_copy_[(row + 1) * values_per_row];
+      data::Nutrient *updated = &ensemble.nutrients_[row * values_per_row];
+      int strip_first_column = first_column + strip * strip_columns;
+      int strip_end_column =
+          std::min(strip_first_column + strip_columns, first_column + number_columns);
+
+      // Loop over the lanes of the strip's columns.
+#pragma omp simd
+      for (int i = strip_first_column * lanes; i < strip_end_column * lanes; i++) {
+        data::Nutrient neighbor_sum = center[i - lanes] + center[i + lanes] +
+                                      above[i - lanes] + above[i] + above[i + lanes] +
+                                      below[i - lanes] + below[i] + below[i + lanes];
+        updated[i] = site_weight * center[i] + neighbor_weight * neighbor_sum;
+      }
+    }
+  }
+}
+
+/// Grow new bacteria through cellular division in every replica, drawing from
+/// one Mersenne Twister engine per replica.
+///
+/// The cells are visited once in the same order as apply_growth_transformation,
+/// and at each cell the lanes that may divide are proposed from their own
+/// engines. Every engine then sees its replica's cells in the usual order, so
+/// each replica grows exactly as a single simulation seeded with its engine's
+/// seed would.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engines Mersenne Twister engine of every replica.
+void apply_ensemble_growth_transformation(
+    EnsembleEntities &ensemble, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::vector<std::mt19937> &random_engines) {
+  // Uniform random number generator for range [0.0, 1.0)
+  std::uniform_real_distribution<double> uniform_rng(0.0, 1.0);
+
+  int lanes = ensemble.lanes_;
+  int cells_per_row = ensemble.cells_per_row();
+  int words_per_row = ensemble.words_per_row();
+  int first_row = ensemble.first_unpadded_row();
+  int last_row = ensemble.last_unpadded_row();
+
+  // Random numbers are drawn in visit order, so proposals run on one thread.
+#pragma omp single
+  for (int row = first_row; row <= last_row; row++) {
+    for (int word = 0; word < words_per_row; word++) {
+      uint64_t live = ensemble.live_cells_[row * words_per_row + word];
+
+      // Visit the set bits from lowest to highest column.
+      while (live != 0u) {
+        Entities::EntityID id = row * cells_per_row + 64 * word + __builtin_ctzll(live);
+        live &= live - 1u;
+        data::FourNeighborIDs neighborhood =
+            get_ensemble_neighbors(id, row, get_neighbors_parameters);
+        uint64_t dividing_lanes = get_ensemble_dividing_lanes(ensemble, id, neighborhood);
+
+        // Visit the set bits from lowest to highest lane.
+        while (dividing_lanes != 0u) {
+          int lane = __builtin_ctzll(dividing_lanes);
+          dividing_lanes &= dividing_lanes - 1u;
+
+          double current_nutrients = ensemble.nutrients_[id * lanes + lane];
+          std::mt19937 &random_engine = random_engines[lane];
+          if ((current_nutrients >= 1.0E-5) &&
+              (uniform_rng(random_engine) < (current_nutrients * probability_division))) {
+            int mask = get_ensemble_empty_neighbor_mask(ensemble, neighborhood, lane);
+            int selected_neighbor =
+                neighbors::sample_random_id(__builtin_popcount(mask), random_engine);
+            record_ensemble_division(
+                ensemble, get_selected_neighbor(neighborhood, mask, selected_neighbor),
+                lane);
+          }
+        }
+      }
+    }
+  }
+
+  resolve_ensemble_divisions(ensemble);
+}
+
+/// Grow new bacteria through cellular division in every replica, drawing from
+/// one counter-based random number generator per replica.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rngs Counter-based random number generator of every
+///   replica.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void apply_ensemble_growth_transformation(
+    EnsembleEntities &ensemble, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const std::vector<rng::CounterRNG> &counter_rngs,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  int lanes = ensemble.lanes_;
+  int cells_per_row = ensemble.cells_per_row();
+  int words_per_row = ensemble.words_per_row();
+  int first_row = ensemble.first_unpadded_row();
+  int last_row = ensemble.last_unpadded_row();
+
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    for (int word = 0; word < words_per_row; word++) {
+      uint64_t live = ensemble.live_cells_[row * words_per_row + word];
+
+      // Visit the set bits from lowest to highest column.
+      while (live != 0u) {
+        int column = 64 * word + __builtin_ctzll(live);
+        live &= live - 1u;
+        Entities::EntityID id = row * cells_per_row + column;
+        data::FourNeighborIDs neighborhood =
+            get_ensemble_neighbors(id, row, get_neighbors_parameters);
+        uint64_t dividing_lanes = get_ensemble_dividing_lanes(ensemble, id, neighborhood);
+
+        // Visit the set bits from lowest to highest lane.
+        while (dividing_lanes != 0u) {
+          int lane = __builtin_ctzll(dividing_lanes);
+          dividing_lanes &= dividing_lanes - 1u;
+
+          double current_nutrients = ensemble.nutrients_[id * lanes + lane];
+          if (current_nutrients < 1.0E-5) {
+            continue;
+          }
+
+          // Random numbers are keyed on the cell id, not on the visit order
+          uint32_t cell_id = cell_id_converter(data::Index{row, column});
+          if (counter_rngs[lane](step, cell_id, rng::kDrawDivide) <
+              (current_nutrients * probability_division)) {
+            int mask = get_ensemble_empty_neighbor_mask(ensemble, neighborhood, lane);
+            int number_empty_neighbors = __builtin_popcount(mask);
+            int selected_neighbor = std::min(
+                static_cast<int>(
+                    counter_rngs[lane](step, cell_id, rng::kDrawPickNeighbor) *
+                    number_empty_neighbors),
+                number_empty_neighbors - 1);
+            record_ensemble_division(
+                ensemble, get_selected_neighbor(neighborhood, mask, selected_neighbor),
+                lane);
+          }
+        }
+      }
+    }
+  }
+
+  resolve_ensemble_divisions(ensemble);
+}
+
+/// Decrease nutrients component of every replica by fixed amount for the live
+/// bacteria only.
+///
+/// The live bacteria are found through the live cells bitboard and the live
+/// lane masks, so only the entities where something lives are visited.
+///
+/// @param [in,out] ensemble EnsembleEntities struct with components defining
+///   the nutrients and bacteria grids of every replica.
+/// @param [in] consumed Amount of nutrients each live bacterium consumes.
+void apply_ensemble_consumption_transformation(
+    EnsembleEntities &ensemble, double consumed) {
+  int lanes = ensemble.lanes_;
+  int cells_per_row = ensemble.cells_per_row();
+  int words_per_row = ensemble.words_per_row();
+  int first_row = ensemble.first_unpadded_row();
+  int last_row = ensemble.last_unpadded_row();
+  data::Nutrient zero = 0.0;
+
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    for (int word = 0; word < words_per_row; word++) {
+      uint64_t live = ensemble.live_cells_[row * words_per_row + word];
+
+      while (live != 0u) {
+        Entities::EntityID id = row * cells_per_row + 64 * word + __builtin_ctzll(live);
+        live &= live - 1u;
+
+        for (uint64_t lanes_left = ensemble.live_lanes_[id]; lanes_left != 0u;
+             lanes_left &= lanes_left - 1u) {
+          data::Nutrient &nutrients =
+              ensemble.nutrients_[id * lanes + __builtin_ctzll(lanes_left)];
+          nutrients = std::max(zero, static_cast<data::Nutrient>(nutrients - consumed));
+        }
+      }
+    }
+  }
+}
+}   // namespace transformers
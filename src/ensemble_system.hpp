@@ -0,0 +1,32 @@
+#ifndef BIOFILM_SIMULATION_ENSEMBLE_SYSTEM_HPP
+#define BIOFILM_SIMULATION_ENSEMBLE_SYSTEM_HPP
+
+#include <random>
+#include <vector>
+
+#include <data.hpp>
+#include <ensemble_entities.hpp>
+#include <rng.hpp>
+#include <utilities.hpp>
+
+namespace transformers {
+void swap_ensemble_states(EnsembleEntities &ensemble);
+void swap_ensemble_nutrients(EnsembleEntities &ensemble);
+void refresh_padded_ensemble_states(EnsembleEntities &ensemble);
+void refresh_padded_ensemble_nutrients(EnsembleEntities &ensemble);
+void apply_ensemble_diffusion_transformation(
+    EnsembleEntities &ensemble, double diffusion_rate);
+void apply_ensemble_growth_transformation(
+    EnsembleEntities &ensemble, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::vector<std::mt19937> &random_engines);
+void apply_ensemble_growth_transformation(
+    EnsembleEntities &ensemble, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const std::vector<rng::CounterRNG> &counter_rngs,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void apply_ensemble_consumption_transformation(
+    EnsembleEntities &ensemble, double consumed);
+}   // namespace transformers
+
+#endif   // BIOFILM_SIMULATION_ENSEMBLE_SYSTEM_HPP
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include <components.hpp>
+#include <data.hpp>
 
 /// Entities are collections of components that represent the grid cells and
 /// states in the simulation.
@@ -18,6 +19,16 @@
 /// nutrients components. By checking for which components are flagged as
 /// active, we can quickly discern if an entity represents a padded cell or a
 /// regular cell.
+///
+/// Entities are laid out on a dense, row-major grid, so an entity's row,
+/// column, location, and active components all follow from its id and the grid
+/// dimensions. The names, indices, locations, and flags components are
+/// therefore metadata that is only filled in when requested, for use by the
+/// debugging helpers.
+///
+/// The bacteria and nutrients components are double buffered with their
+/// copies. At the start of each step the buffers are swapped, so the copies
+/// hold the states from the prior step without copying any values.
 struct Entities {
   typedef int EntityID;
 
@@ -39,6 +50,13 @@ struct Entities {
     kStateBorder = 3,      ///< Cell is in the padded region.
   };
 
+  data::Dimensions dimensions_;           ///< Dimensions of the grid the
+                                          ///< entities are laid out on.
+                                          ///<
+  bool with_metadata_ = false;            ///< Whether the names, indices,
+                                          ///< locations, and flags components
+                                          ///< are filled in.
+                                          ///<
   component::Names names_;                ///< A plain text name for help in
                                           ///< identifying an entity.
                                           ///<
@@ -61,39 +79,133 @@ struct Entities {
   component::Flags flags_;                ///< Bitfield for identifying which
                                           ///< components are active and which are
                                           ///< not for any given entity.
+                                          ///<
+  component::Divisions divisions_;        ///< Cell id the entity's bacterium
+                                          ///< divides into during the current
+                                          ///< growth phase, -1 if none.
+                                          ///<
+  component::Bitboard empty_cells_;       ///< One bit per entity, set when its
+                                          ///< bacteria_copy component is empty.
+                                          ///< Each row is padded to whole 64-bit
+                                          ///< words.
+                                          ///<
+  component::Bitboard live_cells_;        ///< One bit per entity, set when its
+                                          ///< bacteria_copy component is a live
+                                          ///< bacterium.
 
   /// Reserve memory for a set of entities.
   ///
   /// @param [in] n The number of entities you expect to create.
   void reserve(int n) {
-    names_.reserve(n);
-    indices_.reserve(n);
-    locations_.reserve(n);
+    if (with_metadata_) {
+      names_.reserve(n);
+      indices_.reserve(n);
+      locations_.reserve(n);
+      flags_.reserve(n);
+    }
     bacteria_.reserve(n);
     nutrients_.reserve(n);
     bacteria_copy_.reserve(n);
     nutrients_copy_.reserve(n);
-    flags_.reserve(n);
+    divisions_.reserve(n);
+  }
+
+  /// Remove all entities, keeping the memory reserved for them so the
+  /// components can be filled in again without allocating.
+  void clear() {
+    names_.clear();
+    indices_.clear();
+    locations_.clear();
+    flags_.clear();
+    bacteria_.clear();
+    nutrients_.clear();
+    bacteria_copy_.clear();
+    nutrients_copy_.clear();
+    divisions_.clear();
   }
 
   /// Create a new empty entity.
   ///
   /// @param [in] name A plain text name for help in identifying the created
-  ///   entity.
+  ///   entity, only stored when metadata is enabled.
   /// @return The unique integer ID for the entity.
-  EntityID add_entity(std::string &&name) {
-    EntityID id = names_.size();
+  EntityID add_entity(const char *name) {
+    EntityID id = bacteria_.size();
 
-    names_.emplace_back(name);
-    indices_.push_back(data::Index());
-    locations_.push_back(-1);
+    if (with_metadata_) {
+      names_.emplace_back(name);
+      indices_.push_back(data::Index());
+      locations_.push_back(-1);
+      flags_.push_back(0u);
+    }
     bacteria_.push_back(kStateEmpty);
     nutrients_.push_back(0.0);
     bacteria_copy_.push_back(kStateEmpty);
     nutrients_copy_.push_back(0.0);
-    flags_.push_back(0u);
+    divisions_.push_back(-1);
 
     return id;
   }
+
+  /// Count the entities, including the padded cells.
+  ///
+  /// @return The number of entities.
+  int size() const { return bacteria_.size(); }
+
+  /// Count the columns per row in the padded grid.
+  ///
+  /// @return The number of columns there are per row in the padded grid.
+  int cells_per_row() const {
+    return dimensions_.number_columns + 2 * dimensions_.size_padding;
+  }
+
+  /// Count the 64-bit words per row in the bitboard components.
+  ///
+  /// @return The number of words there are per row in the bitboards.
+  int words_per_row() const { return (cells_per_row() + 63) / 64; }
+
+  /// Row index of the first row in the regular, unpadded grid.
+  int first_unpadded_row() const { return dimensions_.size_padding; }
+
+  /// Row index of the last row in the regular, unpadded grid.
+  int last_unpadded_row() const {
+    return dimensions_.size_padding + dimensions_.number_rows - 1;
+  }
+
+  /// Column index of the first column in the regular, unpadded grid.
+  int first_unpadded_column() const { return dimensions_.size_padding; }
+
+  /// Column index of the last column in the regular, unpadded grid.
+  int last_unpadded_column() const {
+    return dimensions_.size_padding + dimensions_.number_columns - 1;
+  }
+
+  /// Compute the (row, column) index of an entity from its id.
+  ///
+  /// @param [in] id Entity id.
+  /// @return Row and column indices of entity.
+  data::Index index(EntityID id) const {
+    return data::Index{id / cells_per_row(), id % cells_per_row()};
+  }
+
+  /// Compute which components are active for an entity from its position.
+  ///
+  /// @param [in] id Entity id.
+  /// @return Bitfield of active components.
+  uint32_t active_components(EntityID id) const {
+    data::Index cell = index(id);
+    uint32_t flags = kFlagBacteriaCopy | kFlagNutrientsCopy;
+
+    if (with_metadata_) {
+      flags |= kFlagCellIndices | kFlagCellLocations;
+    }
+    if ((cell.row >= first_unpadded_row()) && (cell.row <= last_unpadded_row()) &&
+        (cell.column >= first_unpadded_column()) &&
+        (cell.column <= last_unpadded_column())) {
+      flags |= kFlagBacteria | kFlagNutrients;
+    }
+
+    return flags;
+  }
 };
 #endif   // BIOFILM_SIMULATION_ENTITIES_HPP
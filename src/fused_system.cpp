@@ -0,0 +1,147 @@
+#include <fused_system.hpp>
+
+#include <algorithm>
+
+#include <consumption_system.hpp>
+#include <diffusion_system.hpp>
+#include <entities.hpp>
+#include <growth_system.hpp>
+
+namespace transformers {
+/// Bytes of cache a tile of rows should fit in while it is diffused, grown, and
+/// consumed.
+static const int kFusedTileBytes = 256 * 1024;
+
+/// Sweep the grid in tiles of rows, diffusing, growing, and consuming each tile
+/// while it is still in cache.
+///
+/// A row can only be resolved once its own divisions and those of the rows
+/// above and below are proposed, so resolution (and consumption, which reads
+/// the resolved bacteria) lags one row behind the proposals. The first row
+/// wraps around to the last, so it is resolved after the sweep ends. Every row
+/// sees the same inputs as in the phased engine, which gives identical results.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] consumed Amount of nutrients each live bacterium consumes.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] propose_row Function object that proposes the divisions of one
+///   row, called on the rows in order.
+template <typename ProposeRow>
+static void sweep_tiles(
+    Entities &entities, double diffusion_rate, double consumed,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter, ProposeRow propose_row) {
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+  int tile_rows = get_fused_tile_rows(entities);
+
+  for (int tile_first = first_row; tile_first <= last_row; tile_first += tile_rows) {
+    int tile_last = std::min(tile_first + tile_rows - 1, last_row);
+
+    for (int row = tile_first; row <= tile_last; row++) {
+      diffuse_row(entities, diffusion_rate, row);
+    }
+
+    for (int row = tile_first; row <= tile_last; row++) {
+      propose_row(row);
+    }
+
+    // Resolve the rows whose neighbors are now all proposed, skipping the first
+    // row until the last row is proposed.
+    for (int row = std::max(tile_first - 1, first_row + 1); row < tile_last; row++) {
+      resolve_row_divisions(entities, get_neighbors_parameters, cell_id_converter, row);
+      consume_row(entities, consumed, row);
+    }
+  }
+
+  resolve_row_divisions(entities, get_neighbors_parameters, cell_id_converter, last_row);
+  consume_row(entities, consumed, last_row);
+
+  if (first_row != last_row) {
+    resolve_row_divisions(
+        entities, get_neighbors_parameters, cell_id_converter, first_row);
+    consume_row(entities, consumed, first_row);
+  }
+}
+
+/// Number of rows per tile in the fused engine.
+///
+/// A tile holds both nutrients grids, both bacteria grids, and the divisions
+/// component of each of its rows.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @return Number of rows per tile, at least one.
+int get_fused_tile_rows(const Entities &entities) {
+  int bytes_per_row =
+      entities.cells_per_row() *
+      (2 * sizeof(data::Nutrient) + 2 * sizeof(data::BacteriumState) + sizeof(int));
+
+  return std::max(1, kFusedTileBytes / bytes_per_row);
+}
+
+/// Apply the diffusion, growth, and consumption transformations in a single
+/// tiled sweep, drawing from a Mersenne Twister engine.
+///
+/// Rows are proposed in order, so the random numbers are drawn in the same
+/// order as the phased engine.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] consumed Amount of nutrients each live bacterium consumes.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void apply_fused_transformation(
+    Entities &entities, double diffusion_rate, double probability_division,
+    double consumed, const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
+  sweep_tiles(
+      entities, diffusion_rate, consumed, get_neighbors_parameters, cell_id_converter,
+      [&](int row) {
+        propose_row_divisions(
+            entities, probability_division, get_neighbors_parameters, random_engine,
+            cell_id_converter, row);
+      });
+}
+
+/// Apply the diffusion, growth, and consumption transformations in a single
+/// tiled sweep, using counter-based random numbers.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] consumed Amount of nutrients each live bacterium consumes.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void apply_fused_transformation(
+    Entities &entities, double diffusion_rate, double probability_division,
+    double consumed, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  sweep_tiles(
+      entities, diffusion_rate, consumed, get_neighbors_parameters, cell_id_converter,
+      [&](int row) {
+        propose_row_divisions(
+            entities, probability_division, get_neighbors_parameters, counter_rng,
+            cell_id_converter, step, row);
+      });
+}
+}   // namespace transformers
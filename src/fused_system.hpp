@@ -0,0 +1,24 @@
+#ifndef BIOFILM_SIMULATION_FUSED_SYSTEM_HPP
+#define BIOFILM_SIMULATION_FUSED_SYSTEM_HPP
+
+#include <random>
+
+#include <data.hpp>
+#include <entities.hpp>
+#include <rng.hpp>
+#include <utilities.hpp>
+
+namespace transformers {
+int get_fused_tile_rows(const Entities &entities);
+void apply_fused_transformation(
+    Entities &entities, double diffusion_rate, double probability_division,
+    double consumed, const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void apply_fused_transformation(
+    Entities &entities, double diffusion_rate, double probability_division,
+    double consumed, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+}   // namespace transformers
+
+#endif   // BIOFILM_SIMULATION_FUSED_SYSTEM_HPP
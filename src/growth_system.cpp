@@ -1,14 +1,171 @@
 #include <growth_system.hpp>
 
+#include <algorithm>
+#include <iterator>
 #include <random>
+#include <vector>
 
+#include <copy_system.hpp>
 #include <entities.hpp>
 #include <neighbors.hpp>
+#include <rng.hpp>
 #include <utilities.hpp>
 
 namespace transformers {
+/// Record the cell each dividing bacterium in a range of columns of one row
+/// picks, drawing from a Mersenne Twister engine.
+///
+/// Every cell in the range shares the boundary policies, so the empty neighbors
+/// are found without per-cell boundary checks, in one scan that serves both to
+/// test whether the bacterium can divide and to pick the cell it divides into.
+/// Random numbers are drawn in column order.
+///
+/// @tparam ColumnPolicy Column policy of the columns in the range.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] row_policy Row policy of the row.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+/// @param [in] first_column First column of the range in the padded grid.
+/// @param [in] end_column One past the last column of the range.
+template <typename ColumnPolicy>
+static void propose_column_divisions(
+    Entities &entities, double probability_division,
+    const neighbors::PeriodicRows &row_policy, std::mt19937 &random_engine,
+    const utilities::CellIdConverter &cell_id_converter, int row, int first_column,
+    int end_column) {
+  // Uniform random number generator for range [0.0, 1.0)
+  std::uniform_real_distribution<double> uniform_rng(0.0, 1.0);
+
+  int cells_per_row = entities.cells_per_row();
+
+  // Loop over the entities in the range, whose bacteria, bacteria_copy,
+  // nutrients, and nutrients_copy components are always active.
+  for (int column = first_column; column < end_column; column++) {
+    Entities::EntityID id = row * cells_per_row + column;
+    int division = -1;
+
+    // Read current nutrients (this is post-diffusion)
+    double current_nutrients = entities.nutrients_[id];
+
+    // If the bacteria is alive, has nutrients, and an empty neighbor cell...
+    if (entities.bacteria_copy_[id] == Entities::kStateBacterium &&
+        current_nutrients >= 1.0E-5) {
+      data::FourNeighborIDs empty_neighbor_ids;
+      int number_empty_neighbors = neighbors::collect_empty_neighbors<ColumnPolicy>(
+          id, entities, row_policy, empty_neighbor_ids);
+
+      // Sample a random number and check if bacteria will divide, then pick a
+      // random empty cell for expansion
+      if (number_empty_neighbors > 0 &&
+          uniform_rng(random_engine) < (current_nutrients * probability_division)) {
+        int neighbor_id = empty_neighbor_ids[neighbors::sample_random_id(
+            number_empty_neighbors, random_engine)];
+        division = cell_id_converter(entities.index(neighbor_id));
+      }
+    }
+    entities.divisions_[id] = division;
+  }
+}
+
+/// Record the cell each dividing bacterium in a range of columns of one row
+/// picks, using counter-based random numbers.
+///
+/// @tparam ColumnPolicy Column policy of the columns in the range.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] row_policy Row policy of the row.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+/// @param [in] first_column First column of the range in the padded grid.
+/// @param [in] end_column One past the last column of the range.
+template <typename ColumnPolicy>
+static void propose_column_divisions(
+    Entities &entities, double probability_division,
+    const neighbors::PeriodicRows &row_policy, const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step, int row,
+    int first_column, int end_column) {
+  int cells_per_row = entities.cells_per_row();
+
+  for (int column = first_column; column < end_column; column++) {
+    Entities::EntityID id = row * cells_per_row + column;
+    int division = -1;
+    double current_nutrients = entities.nutrients_[id];
+
+    if (entities.bacteria_copy_[id] == Entities::kStateBacterium &&
+        current_nutrients >= 1.0E-5) {
+      data::FourNeighborIDs empty_neighbor_ids;
+      int number_empty_neighbors = neighbors::collect_empty_neighbors<ColumnPolicy>(
+          id, entities, row_policy, empty_neighbor_ids);
+
+      // Random numbers are keyed on the cell id, not on the visit order
+      uint32_t cell_id = cell_id_converter(data::Index{row, column});
+      if (number_empty_neighbors > 0 &&
+          counter_rng(step, cell_id, rng::kDrawDivide) <
+              (current_nutrients * probability_division)) {
+        int neighbor_id = empty_neighbor_ids[neighbors::sample_random_id(
+            number_empty_neighbors, counter_rng(step, cell_id, rng::kDrawPickNeighbor))];
+        division = cell_id_converter(entities.index(neighbor_id));
+      }
+    }
+    entities.divisions_[id] = division;
+  }
+}
+
+/// Compute the new bacteria state of every cell in a range of columns of one
+/// row from the proposed divisions.
+///
+/// @tparam ColumnPolicy Column policy of the columns in the range.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] row_policy Row policy of the row.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+/// @param [in] first_column First column of the range in the padded grid.
+/// @param [in] end_column One past the last column of the range.
+template <typename ColumnPolicy>
+static void resolve_column_divisions(
+    Entities &entities, const neighbors::PeriodicRows &row_policy,
+    const utilities::CellIdConverter &cell_id_converter, int row, int first_column,
+    int end_column) {
+  int cells_per_row = entities.cells_per_row();
+
+  for (int column = first_column; column < end_column; column++) {
+    Entities::EntityID id = row * cells_per_row + column;
+    int state = entities.bacteria_copy_[id];
+
+    if ((state == Entities::kStateBacterium) && (entities.nutrients_[id] < 1.0E-5)) {
+      state = Entities::kStateDead;
+    } else if (state == Entities::kStateEmpty) {
+      int cell_id = cell_id_converter(data::Index{row, column});
+      if (neighbors::check_for_dividing_neighbors<ColumnPolicy>(
+              id, entities, row_policy, cell_id)) {
+        state = Entities::kStateBacterium;
+      }
+    }
+    entities.bacteria_[id] = state;
+  }
+}
+
 /// Grow new bacteria through cellular division if nutrients are available.
 ///
+/// The growth phase runs in two passes. The first pass proposes divisions,
+/// the second computes every cell's new state from the previous step's state
+/// and the proposals of its neighbors. Two bacteria picking the same empty
+/// cell both produce the same live bacterium, so the proposals can be resolved
+/// in any order.
+///
 /// @param [in,out] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 /// @param [in] probability_division Probability that a cell will divide
@@ -17,59 +174,971 @@ namespace transformers {
 ///   sites.
 /// @param [in,out] random_engine Mersenne Twister engine for random number
 /// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void apply_growth_transformation(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
+  propose_divisions(
+      entities, probability_division, get_neighbors_parameters, random_engine,
+      cell_id_converter);
+  resolve_divisions(entities, get_neighbors_parameters, cell_id_converter);
+}
+
+/// Grow new bacteria through cellular division using counter-based random
+/// numbers.
+///
+/// Follows the same rules as the Mersenne Twister version, but every random
+/// number is drawn as a pure function of (seed, step, cell id, draw index).
+/// Both passes only write to the entity being visited, so the outcome does not
+/// depend on visit order and both passes can be shared across threads.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
 void apply_growth_transformation(
     Entities &entities, double probability_division,
     const data::GetNeighborsParameters &get_neighbors_parameters,
-    std::mt19937 &random_engine) {
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  propose_divisions(
+      entities, probability_division, get_neighbors_parameters, counter_rng,
+      cell_id_converter, step);
+  resolve_divisions(entities, get_neighbors_parameters, cell_id_converter);
+}
+
+/// Record the cell each dividing bacterium picks, drawing from a Mersenne
+/// Twister engine.
+///
+/// Random numbers are drawn in visit order, so this pass must run on a single
+/// thread.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void propose_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+
+  // Loop over the unpadded rows in order.
+  for (int row = first_row; row <= last_row; row++) {
+    propose_row_divisions(
+        entities, probability_division, get_neighbors_parameters, random_engine,
+        cell_id_converter, row);
+  }
+}
+
+/// Record the cell each dividing bacterium picks, using counter-based random
+/// numbers.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void propose_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+
+  // Loop over the unpadded rows.
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    propose_row_divisions(
+        entities, probability_division, get_neighbors_parameters, counter_rng,
+        cell_id_converter, step, row);
+  }
+}
+
+/// Compute the new bacteria state of every cell from the proposed divisions.
+///
+/// Starved bacteria die, empty cells that a neighbor divides into get a live
+/// bacterium, and all other cells keep the state from the previous step. Every
+/// unpadded cell is written, so the bacteria component does not need to hold a
+/// copy of the previous step beforehand.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void resolve_divisions(
+    Entities &entities, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter) {
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+
+  // Loop over the unpadded rows.
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    resolve_row_divisions(entities, get_neighbors_parameters, cell_id_converter, row);
+  }
+}
+
+/// Record the cell each dividing bacterium in one unpadded row picks.
+///
+/// Random numbers are drawn in column order. The first and last columns are
+/// swept apart from the interior columns, so each sweep knows its boundaries
+/// at compile time.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+void propose_row_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter,
+    int row) {
+  neighbors::PeriodicRows row_policy(row, get_neighbors_parameters);
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+  // Sweep the first column, interior columns, and last column in order, each
+  // with its own column policy
+  propose_column_divisions<neighbors::FirstColumn>(
+      entities, probability_division, row_policy, random_engine, cell_id_converter,
+      row, first_column, first_column + 1);
+  if (last_column > first_column) {
+    propose_column_divisions<neighbors::InteriorColumns>(
+        entities, probability_division, row_policy, random_engine, cell_id_converter,
+        row, first_column + 1, last_column);
+    propose_column_divisions<neighbors::LastColumn>(
+        entities, probability_division, row_policy, random_engine, cell_id_converter,
+        row, last_column, last_column + 1);
+  }
+}
+
+/// Record the cell each dividing bacterium in one unpadded row picks, using
+/// counter-based random numbers.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+void propose_row_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step, int row) {
+  neighbors::PeriodicRows row_policy(row, get_neighbors_parameters);
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+  propose_column_divisions<neighbors::FirstColumn>(
+      entities, probability_division, row_policy, counter_rng, cell_id_converter, step,
+      row, first_column, first_column + 1);
+  if (last_column > first_column) {
+    propose_column_divisions<neighbors::InteriorColumns>(
+        entities, probability_division, row_policy, counter_rng, cell_id_converter, step,
+        row, first_column + 1, last_column);
+    propose_column_divisions<neighbors::LastColumn>(
+        entities, probability_division, row_policy, counter_rng, cell_id_converter, step,
+        row, last_column, last_column + 1);
+  }
+}
+
+/// Compute the new bacteria state of every cell in one unpadded row from the
+/// proposed divisions.
+///
+/// Reads the divisions of the rows above and below, so those rows must be
+/// proposed first. The first and last columns are swept apart from the
+/// interior columns, as in propose_row_divisions.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] row Row index of the unpadded row in the padded grid.
+void resolve_row_divisions(
+    Entities &entities, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter, int row) {
+  neighbors::PeriodicRows row_policy(row, get_neighbors_parameters);
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+  resolve_column_divisions<neighbors::FirstColumn>(
+      entities, row_policy, cell_id_converter, row, first_column, first_column + 1);
+  if (last_column > first_column) {
+    resolve_column_divisions<neighbors::InteriorColumns>(
+        entities, row_policy, cell_id_converter, row, first_column + 1, last_column);
+    resolve_column_divisions<neighbors::LastColumn>(
+        entities, row_policy, cell_id_converter, row, last_column, last_column + 1);
+  }
+}
+
+/// Grow new bacteria through cellular division, finding the bacteria with an
+/// empty neighbor from the bitboards.
+///
+/// Gives the same results as apply_growth_transformation. The padded states
+/// must be refreshed (or exchanged) beforehand, since the bitboards are packed
+/// from the padded grid.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void apply_bitboard_growth_transformation(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
+  refresh_bitboards(entities);
+  propose_bitboard_divisions(
+      entities, probability_division, get_neighbors_parameters, random_engine,
+      cell_id_converter);
+  resolve_bitboard_divisions(entities, get_neighbors_parameters, cell_id_converter);
+}
+
+/// Grow new bacteria through cellular division using counter-based random
+/// numbers, finding the bacteria with an empty neighbor from the bitboards.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void apply_bitboard_growth_transformation(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  refresh_bitboards(entities);
+  propose_bitboard_divisions(
+      entities, probability_division, get_neighbors_parameters, counter_rng,
+      cell_id_converter, step);
+  resolve_bitboard_divisions(entities, get_neighbors_parameters, cell_id_converter);
+}
+
+/// Record the cell each dividing bacterium picks, testing 64 cells at a time
+/// for an empty neighbor.
+///
+/// Live bacteria with an empty neighbor are found by combining the bitboard
+/// words of a row and the rows above and below, and are then visited in
+/// entity id order, so the random numbers are drawn in the same order as in
+/// propose_divisions. The bitboards must be refreshed beforehand.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void propose_bitboard_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
   // Uniform random number generator for range [0.0, 1.0)
   std::uniform_real_distribution<double> uniform_rng(0.0, 1.0);
 
-  // Count number of entities in simulation.
-  int num_entities = entities.names_.size();
-
-  // Mask: bacteria, bacteria_copy, nutrients, and nutrients_copy components are
-  // active
-  uint32_t transform_flag = Entities::kFlagBacteria | Entities::kFlagBacteriaCopy |
-                            Entities::kFlagNutrients | Entities::kFlagNutrientsCopy;
-
-  // Loop over all entities regardless of active components.
-  for (Entities::EntityID id = 0; id < num_entities; id++) {
-    // Check if current entity's bacteria, bacteria_copy, nutrients, and
-    // nutrients_copy components are active
-    uint32_t flag_check = transform_flag & entities.flags_[id];
-    if (flag_check == transform_flag) {
-      // If active, read current nutrients (this is post-diffusion)
-      double current_nutrients = entities.nutrients_[id];
-
-      // Check is bacteria is alive
-      bool bacterium_alive = entities.bacteria_copy_[id] == Entities::kStateBacterium;
-
-      // Check if nutrients have run out
-      bool no_nutrients_left = current_nutrients < 1.0E-5;
-
-      // Check for at least one empty neighbor in bacteria grid
-      bool has_empty_neighbor =
-          neighbors::check_for_empty_neighbors(id, entities, get_neighbors_parameters);
-
-      // If bacteria is alive but has no nutrients...
-      if (bacterium_alive & no_nutrients_left) {
-        // The bacteria dies
-        entities.bacteria_[id] = Entities::kStateDead;
-
-        // If the bacteria is alive, has nutrients, and an empty neighbor
-        // cell...
-      } else if (bacterium_alive & has_empty_neighbor) {
-        // Sample a random number and check if bacteria will divide
-        if (uniform_rng(random_engine) < (current_nutrients * probability_division)) {
-          // If bacteria will divide, then pick a random empty cell for
-          // expansion
-          int neighbor_id = neighbors::pick_bacterium_neighbor(
-              id, entities, get_neighbors_parameters, random_engine);
-          // and insert live bacterium into empty cell that was picked
-          entities.bacteria_[neighbor_id] = Entities::kStateBacterium;
+  int cells_per_row = entities.cells_per_row();
+  int words_per_row = entities.words_per_row();
+
+  for (int row = entities.first_unpadded_row(); row <= entities.last_unpadded_row();
+       row++) {
+    Entities::EntityID row_start = row * cells_per_row;
+    std::fill(
+        entities.divisions_.begin() + row_start + entities.first_unpadded_column(),
+        entities.divisions_.begin() + row_start + entities.last_unpadded_column() + 1,
+        -1);
+
+    for (int word = 0; word < words_per_row; word++) {
+      uint64_t candidates = entities.live_cells_[row * words_per_row + word] &
+                            neighbors::get_neighbor_word(
+                                entities, entities.empty_cells_, row, word);
+
+      // Visit the set bits from lowest to highest column.
+      while (candidates != 0u) {
+        Entities::EntityID id = row_start + 64 * word + __builtin_ctzll(candidates);
+        candidates &= candidates - 1u;
+
+        double current_nutrients = entities.nutrients_[id];
+        if ((current_nutrients >= 1.0E-5) &&
+            (uniform_rng(random_engine) < (current_nutrients * probability_division))) {
+          int neighbor_id = neighbors::pick_empty_neighbor(
+              id, entities, get_neighbors_parameters,
+              neighbors::get_empty_neighbor_mask(id, entities), random_engine);
+          entities.divisions_[id] = cell_id_converter(entities.index(neighbor_id));
+        }
+      }
+    }
+  }
+}
+
+/// Record the cell each dividing bacterium picks using counter-based random
+/// numbers, testing 64 cells at a time for an empty neighbor.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void propose_bitboard_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  int cells_per_row = entities.cells_per_row();
+  int words_per_row = entities.words_per_row();
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    Entities::EntityID row_start = row * cells_per_row;
+    std::fill(
+        entities.divisions_.begin() + row_start + entities.first_unpadded_column(),
+        entities.divisions_.begin() + row_start + entities.last_unpadded_column() + 1,
+        -1);
+
+    for (int word = 0; word < words_per_row; word++) {
+      uint64_t candidates = entities.live_cells_[row * words_per_row + word] &
+                            neighbors::get_neighbor_word(
+                                entities, entities.empty_cells_, row, word);
+
+      while (candidates != 0u) {
+        Entities::EntityID id = row_start + 64 * word + __builtin_ctzll(candidates);
+        candidates &= candidates - 1u;
+
+        double current_nutrients = entities.nutrients_[id];
+        if (current_nutrients < 1.0E-5) {
+          continue;
         }
+
+        // Random numbers are keyed on the cell id, not on the visit order
+        uint32_t cell_id = cell_id_converter(entities.index(id));
+        if (counter_rng(step, cell_id, rng::kDrawDivide) <
+            (current_nutrients * probability_division)) {
+          int neighbor_id = neighbors::pick_empty_neighbor(
+              id, entities, get_neighbors_parameters,
+              neighbors::get_empty_neighbor_mask(id, entities),
+              counter_rng(step, cell_id, rng::kDrawPickNeighbor));
+          entities.divisions_[id] = cell_id_converter(entities.index(neighbor_id));
+        }
+      }
+    }
+  }
+}
+
+/// Compute the new bacteria state of every cell from the proposed divisions,
+/// using the bitboards to find the cells that can change.
+///
+/// Gives the same results as resolve_divisions. Each row of states is copied
+/// over from the previous step, then only the live bacteria are checked for
+/// starvation and only the empty cells next to a live bacterium are checked for
+/// a dividing neighbor. The reachable cells in the first and last columns are
+/// masked out of their words and checked with their own column policies. The
+/// bitboards must be refreshed beforehand.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void resolve_bitboard_divisions(
+    Entities &entities, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter) {
+  int cells_per_row = entities.cells_per_row();
+  int words_per_row = entities.words_per_row();
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+  // Bitboard words and bits of the first and last columns.
+  int first_word = first_column / 64;
+  int last_word = last_column / 64;
+  uint64_t first_bit = uint64_t{1} << (first_column % 64);
+  uint64_t last_bit = uint64_t{1} << (last_column % 64);
+
+#pragma omp for schedule(static)
+  for (int row = first_row; row <= last_row; row++) {
+    Entities::EntityID row_start = row * cells_per_row;
+    neighbors::PeriodicRows row_policy(row, get_neighbors_parameters);
+    std::copy(
+        entities.bacteria_copy_.begin() + row_start + first_column,
+        entities.bacteria_copy_.begin() + row_start + last_column + 1,
+        entities.bacteria_.begin() + row_start + first_column);
+
+    for (int word = 0; word < words_per_row; word++) {
+      // Live bacteria die when they run out of nutrients.
+      uint64_t live = entities.live_cells_[row * words_per_row + word];
+      while (live != 0u) {
+        Entities::EntityID id = row_start + 64 * word + __builtin_ctzll(live);
+        live &= live - 1u;
+
+        if (entities.nutrients_[id] < 1.0E-5) {
+          entities.bacteria_[id] = Entities::kStateDead;
+        }
+      }
+
+      // Only empty cells next to a live bacterium can be divided into.
+      uint64_t reachable = entities.empty_cells_[row * words_per_row + word] &
+                           neighbors::get_neighbor_word(
+                               entities, entities.live_cells_, row, word);
+      if (word == first_word && (reachable & first_bit) != 0u) {
+        reachable &= ~first_bit;
+
+        Entities::EntityID id = row_start + first_column;
+        int cell_id = cell_id_converter(data::Index{row, first_column});
+        if (neighbors::check_for_dividing_neighbors<neighbors::FirstColumn>(
+                id, entities, row_policy, cell_id)) {
+          entities.bacteria_[id] = Entities::kStateBacterium;
+        }
+      }
+      if (word == last_word && (reachable & last_bit) != 0u) {
+        reachable &= ~last_bit;
+
+        Entities::EntityID id = row_start + last_column;
+        int cell_id = cell_id_converter(data::Index{row, last_column});
+        if (neighbors::check_for_dividing_neighbors<neighbors::LastColumn>(
+                id, entities, row_policy, cell_id)) {
+          entities.bacteria_[id] = Entities::kStateBacterium;
+        }
+      }
+      while (reachable != 0u) {
+        int column = 64 * word + __builtin_ctzll(reachable);
+        reachable &= reachable - 1u;
+
+        Entities::EntityID id = row_start + column;
+        int cell_id = cell_id_converter(data::Index{row, column});
+        if (neighbors::check_for_dividing_neighbors<neighbors::InteriorColumns>(
+                id, entities, row_policy, cell_id)) {
+          entities.bacteria_[id] = Entities::kStateBacterium;
+        }
+      }
+    }
+  }
+}
+
+/// Number of frontier bacteria per chunk shared out among the threads by the
+/// counter-based frontier growth engine.
+static const int kFrontierChunk = 256;
+
+/// Find the frontier bacteria in the row of the bacterium at a given position,
+/// and split them by column policy.
+///
+/// The frontier is sorted by entity id, so the bacteria of a row are adjacent,
+/// with the one in the first column (if any) at the start and the one in the
+/// last column (if any) at the end.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] frontier Entity ids of the frontier bacteria, sorted.
+/// @param [in] begin Position of the first bacterium to split.
+/// @param [in] end Position one past the last bacterium that may be included.
+/// @return FrontierRow struct with the positions of the row's bacteria.
+static data::FrontierRow split_frontier_row(
+    const Entities &entities, const std::vector<int> &frontier, int begin, int end) {
+  int cells_per_row = entities.cells_per_row();
+
+  data::FrontierRow frontier_row;
+  frontier_row.row = frontier[begin] / cells_per_row;
+  int row_start = frontier_row.row * cells_per_row;
+
+  frontier_row.end = begin + 1;
+  int row_end = row_start + cells_per_row;
+  while (frontier_row.end < end && frontier[frontier_row.end] < row_end) {
+    frontier_row.end++;
+  }
+
+  frontier_row.interior_begin = begin;
+  if (frontier[begin] == row_start + entities.first_unpadded_column()) {
+    frontier_row.interior_begin++;
+  }
+  frontier_row.interior_end = frontier_row.end;
+  if (frontier_row.interior_end > frontier_row.interior_begin &&
+      frontier[frontier_row.end - 1] == row_start + entities.last_unpadded_column()) {
+    frontier_row.interior_end--;
+  }
+
+  return frontier_row;
+}
+
+/// Record the cell each dividing frontier bacterium in a range of positions
+/// picks, drawing from a Mersenne Twister engine.
+///
+/// @tparam ColumnPolicy Column policy shared by the bacteria in the range.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] row_policy Row policy of the bacteria in the range.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] begin Position of the first frontier bacterium in the range.
+/// @param [in] end Position one past the last frontier bacterium in the range.
+template <typename ColumnPolicy>
+static void propose_frontier_range(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const neighbors::PeriodicRows &row_policy, std::mt19937 &random_engine,
+    const utilities::CellIdConverter &cell_id_converter, int begin, int end) {
+  // Uniform random number generator for range [0.0, 1.0)
+  std::uniform_real_distribution<double> uniform_rng(0.0, 1.0);
+
+  for (int i = begin; i < end; i++) {
+    Entities::EntityID id = active_cells.frontier[i];
+    int division = -1;
+    int target = -1;
+    double current_nutrients = entities.nutrients_[id];
+
+    if (current_nutrients >= 1.0E-5) {
+      data::FourNeighborIDs empty_neighbor_ids;
+      int number_empty_neighbors = neighbors::collect_empty_neighbors<ColumnPolicy>(
+          id, entities, row_policy, empty_neighbor_ids);
+      if (number_empty_neighbors > 0 &&
+          uniform_rng(random_engine) < (current_nutrients * probability_division)) {
+        target = empty_neighbor_ids[neighbors::sample_random_id(
+            number_empty_neighbors, random_engine)];
+        division = cell_id_converter(entities.index(target));
       }
     }
+    entities.divisions_[id] = division;
+    active_cells.targets[i] = target;
   }
 }
+
+/// Record the cell each dividing frontier bacterium in a range of positions
+/// picks, using counter-based random numbers.
+///
+/// @tparam ColumnPolicy Column policy shared by the bacteria in the range.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] row_policy Row policy of the bacteria in the range.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+/// @param [in] begin Position of the first frontier bacterium in the range.
+/// @param [in] end Position one past the last frontier bacterium in the range.
+template <typename ColumnPolicy>
+static void propose_frontier_range(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const neighbors::PeriodicRows &row_policy, const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step, int begin,
+    int end) {
+  for (int i = begin; i < end; i++) {
+    Entities::EntityID id = active_cells.frontier[i];
+    int division = -1;
+    int target = -1;
+    double current_nutrients = entities.nutrients_[id];
+
+    if (current_nutrients >= 1.0E-5) {
+      data::FourNeighborIDs empty_neighbor_ids;
+      int number_empty_neighbors = neighbors::collect_empty_neighbors<ColumnPolicy>(
+          id, entities, row_policy, empty_neighbor_ids);
+      uint32_t cell_id = cell_id_converter(entities.index(id));
+      if (number_empty_neighbors > 0 &&
+          counter_rng(step, cell_id, rng::kDrawDivide) <
+              (current_nutrients * probability_division)) {
+        target = empty_neighbor_ids[neighbors::sample_random_id(
+            number_empty_neighbors, counter_rng(step, cell_id, rng::kDrawPickNeighbor))];
+        division = cell_id_converter(entities.index(target));
+      }
+    }
+    entities.divisions_[id] = division;
+    active_cells.targets[i] = target;
+  }
+}
+
+/// Sort the frontier bacteria in a range of positions into the ones that
+/// starved, the ones left without an empty neighbor, and the rest, which stay
+/// in the frontier.
+///
+/// The frontier is compacted in place, so the range must not start before
+/// number_frontier.
+///
+/// @tparam ColumnPolicy Column policy shared by the bacteria in the range.
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] row_policy Row policy of the bacteria in the range.
+/// @param [in] begin Position of the first frontier bacterium in the range.
+/// @param [in] end Position one past the last frontier bacterium in the range.
+/// @param [in,out] number_frontier Number of bacteria kept in the frontier so
+///   far.
+template <typename ColumnPolicy>
+static void retire_frontier_range(
+    Entities &entities, data::ActiveCells &active_cells,
+    const neighbors::PeriodicRows &row_policy, int begin, int end,
+    int &number_frontier) {
+  for (int i = begin; i < end; i++) {
+    Entities::EntityID id = active_cells.frontier[i];
+    data::FourNeighborIDs empty_neighbor_ids;
+
+    if (entities.nutrients_[id] < 1.0E-5) {
+      active_cells.deaths.push_back(id);
+    } else if (neighbors::collect_empty_neighbors<ColumnPolicy>(
+                   id, entities, row_policy, empty_neighbor_ids) > 0) {
+      active_cells.frontier[number_frontier++] = id;
+    } else {
+      entities.divisions_[id] = -1;
+      active_cells.interior.push_back(id);
+    }
+  }
+}
+
+/// Grow new bacteria through cellular division, visiting only live bacteria.
+///
+/// Gives the same results as apply_growth_transformation, but the cost scales
+/// with the number of live bacteria instead of the size of the grid.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void apply_frontier_growth_transformation(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
+  propose_frontier_divisions(
+      entities, active_cells, probability_division, get_neighbors_parameters,
+      random_engine, cell_id_converter);
+  resolve_frontier_divisions(
+      entities, active_cells, get_neighbors_parameters, cell_id_converter);
+}
+
+/// Grow new bacteria through cellular division using counter-based random
+/// numbers, visiting only live bacteria.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void apply_frontier_growth_transformation(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  propose_frontier_divisions(
+      entities, active_cells, probability_division, get_neighbors_parameters,
+      counter_rng, cell_id_converter, step);
+  resolve_frontier_divisions(
+      entities, active_cells, get_neighbors_parameters, cell_id_converter);
+}
+
+/// Record the cell each dividing frontier bacterium picks.
+///
+/// Only frontier bacteria can have an empty neighbor, and they are visited in
+/// entity id order, so the random numbers are drawn in the same order as in
+/// propose_divisions. The empty neighbors are found in one scan that serves
+/// both to test whether the bacterium can divide and to pick the cell it
+/// divides into.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// generation.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void propose_frontier_divisions(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter) {
+  int num_frontier = active_cells.frontier.size();
+
+  for (int begin = 0; begin < num_frontier;) {
+    data::FrontierRow frontier_row =
+        split_frontier_row(entities, active_cells.frontier, begin, num_frontier);
+    neighbors::PeriodicRows row_policy(frontier_row.row, get_neighbors_parameters);
+
+    propose_frontier_range<neighbors::FirstColumn>(
+        entities, active_cells, probability_division, row_policy, random_engine,
+        cell_id_converter, begin, frontier_row.interior_begin);
+    propose_frontier_range<neighbors::InteriorColumns>(
+        entities, active_cells, probability_division, row_policy, random_engine,
+        cell_id_converter, frontier_row.interior_begin, frontier_row.interior_end);
+    propose_frontier_range<neighbors::LastColumn>(
+        entities, active_cells, probability_division, row_policy, random_engine,
+        cell_id_converter, frontier_row.interior_end, frontier_row.end);
+    begin = frontier_row.end;
+  }
+}
+
+/// Record the cell each dividing frontier bacterium picks, using counter-based
+/// random numbers.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] probability_division Probability that a cell will divide
+///   (scales nutrients value).
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids used as random number counters.
+/// @param [in] step Time step the random numbers are drawn for.
+void propose_frontier_divisions(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step) {
+  int num_frontier = active_cells.frontier.size();
+  int num_chunks = (num_frontier + kFrontierChunk - 1) / kFrontierChunk;
+
+#pragma omp for schedule(static)
+  for (int chunk = 0; chunk < num_chunks; chunk++) {
+    int chunk_end = std::min((chunk + 1) * kFrontierChunk, num_frontier);
+
+    for (int begin = chunk * kFrontierChunk; begin < chunk_end;) {
+      data::FrontierRow frontier_row =
+          split_frontier_row(entities, active_cells.frontier, begin, chunk_end);
+      neighbors::PeriodicRows row_policy(frontier_row.row, get_neighbors_parameters);
+
+      propose_frontier_range<neighbors::FirstColumn>(
+          entities, active_cells, probability_division, row_policy, counter_rng,
+          cell_id_converter, step, begin, frontier_row.interior_begin);
+      propose_frontier_range<neighbors::InteriorColumns>(
+          entities, active_cells, probability_division, row_policy, counter_rng,
+          cell_id_converter, step, frontier_row.interior_begin,
+          frontier_row.interior_end);
+      propose_frontier_range<neighbors::LastColumn>(
+          entities, active_cells, probability_division, row_policy, counter_rng,
+          cell_id_converter, step, frontier_row.interior_end, frontier_row.end);
+      begin = frontier_row.end;
+    }
+  }
+}
+
+/// Find the births and deaths of the current growth phase and update the
+/// lists of live bacteria to match.
+///
+/// Births come from the targets of the frontier bacteria that fall inside the
+/// unpadded grid, plus, when the padded rows hold another process's rows, the
+/// divisions proposed from the padded rows into this grid. Frontier bacteria
+/// that have no empty neighbor left move to the interior list for good.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+static void update_active_cells(
+    Entities &entities, data::ActiveCells &active_cells,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter) {
+  std::vector<int> &births = active_cells.births;
+  std::vector<int> &deaths = active_cells.deaths;
+  births.clear();
+  deaths.clear();
+
+  int cells_per_row = entities.cells_per_row();
+  int first_unpadded_id = entities.first_unpadded_row() * cells_per_row;
+  int last_unpadded_id = (entities.last_unpadded_row() + 1) * cells_per_row - 1;
+
+  // Divisions of frontier bacteria into the unpadded grid.
+  for (int target : active_cells.targets) {
+    if ((target >= first_unpadded_id) && (target <= last_unpadded_id)) {
+      births.push_back(target);
+    }
+  }
+
+  // Divisions proposed from the padded rows into the first and last unpadded
+  // rows. The padded rows' divisions stay at -1 unless they are exchanged with
+  // another process.
+  int top_padded_row = first_unpadded_id - cells_per_row;
+  int bottom_padded_row = last_unpadded_id + 1;
+  for (int column = entities.first_unpadded_column();
+       column <= entities.last_unpadded_column(); column++) {
+    int top_id = top_padded_row + column;
+    int below_id = top_id + cells_per_row;
+    if ((entities.divisions_[top_id] != -1) &&
+        (entities.bacteria_copy_[below_id] == Entities::kStateEmpty) &&
+        (entities.divisions_[top_id] == cell_id_converter(entities.index(below_id)))) {
+      births.push_back(below_id);
+    }
+
+    int bottom_id = bottom_padded_row + column;
+    int above_id = bottom_id - cells_per_row;
+    if ((entities.divisions_[bottom_id] != -1) &&
+        (entities.bacteria_copy_[above_id] == Entities::kStateEmpty) &&
+        (entities.divisions_[bottom_id] == cell_id_converter(entities.index(above_id)))) {
+      births.push_back(above_id);
+    }
+  }
+
+  // Two bacteria can pick the same empty cell.
+  std::sort(births.begin(), births.end());
+  births.erase(std::unique(births.begin(), births.end()), births.end());
+
+  // Starved interior bacteria die, the rest stay in the interior.
+  int num_interior = 0;
+  for (int id : active_cells.interior) {
+    if (entities.nutrients_[id] < 1.0E-5) {
+      deaths.push_back(id);
+    } else {
+      active_cells.interior[num_interior++] = id;
+    }
+  }
+  active_cells.interior.resize(num_interior);
+
+  // Starved frontier bacteria die, the ones without an empty neighbor move to
+  // the interior, the rest stay in the frontier.
+  int num_frontier = 0;
+  int old_num_frontier = active_cells.frontier.size();
+  for (int begin = 0; begin < old_num_frontier;) {
+    data::FrontierRow frontier_row =
+        split_frontier_row(entities, active_cells.frontier, begin, old_num_frontier);
+    neighbors::PeriodicRows row_policy(frontier_row.row, get_neighbors_parameters);
+
+    retire_frontier_range<neighbors::FirstColumn>(
+        entities, active_cells, row_policy, begin, frontier_row.interior_begin,
+        num_frontier);
+    retire_frontier_range<neighbors::InteriorColumns>(
+        entities, active_cells, row_policy, frontier_row.interior_begin,
+        frontier_row.interior_end, num_frontier);
+    retire_frontier_range<neighbors::LastColumn>(
+        entities, active_cells, row_policy, frontier_row.interior_end,
+        frontier_row.end, num_frontier);
+    begin = frontier_row.end;
+  }
+  active_cells.frontier.resize(num_frontier);
+
+  // Newborn bacteria join the frontier, which stays sorted by entity id.
+  std::vector<int> frontier;
+  frontier.reserve(active_cells.frontier.size() + births.size());
+  std::merge(
+      active_cells.frontier.begin(), active_cells.frontier.end(), births.begin(),
+      births.end(), std::back_inserter(frontier));
+  active_cells.frontier.swap(frontier);
+  active_cells.targets.assign(active_cells.frontier.size(), -1);
+}
+
+/// Write the births and deaths of a growth phase to the bacteria component.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] active_cells Entity ids of the live bacteria.
+static void
+apply_state_changes(Entities &entities, const data::ActiveCells &active_cells) {
+  int num_births = active_cells.births.size();
+  int num_deaths = active_cells.deaths.size();
+
+#pragma omp for schedule(static) nowait
+  for (int i = 0; i < num_births; i++) {
+    entities.bacteria_[active_cells.births[i]] = Entities::kStateBacterium;
+  }
+
+#pragma omp for schedule(static)
+  for (int i = 0; i < num_deaths; i++) {
+    entities.bacteria_[active_cells.deaths[i]] = Entities::kStateDead;
+  }
+}
+
+/// Compute the new bacteria state of the live bacteria and the cells they
+/// divide into.
+///
+/// Only the cells that change are written. The bacteria component still holds
+/// the states from two steps ago after the buffers are swapped, so the births
+/// and deaths of the previous growth phase are applied first to bring it up to
+/// date with the bacteria_copy component.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in,out] active_cells Entity ids of the live bacteria.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+void resolve_frontier_divisions(
+    Entities &entities, data::ActiveCells &active_cells,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter) {
+  apply_state_changes(entities, active_cells);
+#pragma omp single
+  update_active_cells(
+      entities, active_cells, get_neighbors_parameters, cell_id_converter);
+  apply_state_changes(entities, active_cells);
+}
 }   // namespace transformers
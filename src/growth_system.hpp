@@ -4,12 +4,86 @@
 #include <random>
 
 #include <entities.hpp>
+#include <rng.hpp>
 #include <utilities.hpp>
 
 namespace transformers {
 void apply_growth_transformation(
     Entities &entities, double probability_division,
     const data::GetNeighborsParameters &get_neighbors_parameters,
-    std::mt19937 &random_engine);
-}
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void apply_growth_transformation(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void propose_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void propose_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void resolve_divisions(
+    Entities &entities, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter);
+void propose_row_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter,
+    int row);
+void propose_row_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step, int row);
+void resolve_row_divisions(
+    Entities &entities, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter, int row);
+void apply_bitboard_growth_transformation(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void apply_bitboard_growth_transformation(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void propose_bitboard_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void propose_bitboard_divisions(
+    Entities &entities, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void resolve_bitboard_divisions(
+    Entities &entities, const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter);
+void apply_frontier_growth_transformation(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void apply_frontier_growth_transformation(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void propose_frontier_divisions(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    std::mt19937 &random_engine, const utilities::CellIdConverter &cell_id_converter);
+void propose_frontier_divisions(
+    Entities &entities, data::ActiveCells &active_cells, double probability_division,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter, uint32_t step);
+void resolve_frontier_divisions(
+    Entities &entities, data::ActiveCells &active_cells,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter);
+}   // namespace transformers
 #endif   // BIOFILM_SIMULATION_GROWTH_SYSTEM_HPP
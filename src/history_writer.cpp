@@ -0,0 +1,167 @@
+#include <history_writer.hpp>
+
+#include <chrono>
+
+#include <utilities.hpp>
+
+namespace utilities {
+/// Start the writer thread, if saving is enabled.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface. The output filename and history queue depth are read from it.
+/// @param [in] enabled Whether this process saves the history, false when no
+///   output filename is set or on MPI processes other than the root.
+HistoryWriter::HistoryWriter(const cli_parameters_t &cli_parameters, bool enabled)
+    : kcli_parameters_(cli_parameters),
+      kenabled_(enabled && !cli_parameters.output_filename.empty()),
+      closed_(false),
+      stall_time_(0.0) {
+  delta_state_.number_frames = 0;
+
+  if (kenabled_) {
+    buffers_.resize(cli_parameters.history_queue_depth);
+    for (int buffer = 0; buffer < cli_parameters.history_queue_depth; buffer++) {
+      free_buffers_.push_back(buffer);
+    }
+    thread_ = std::thread(&HistoryWriter::run, this);
+  }
+}
+
+/// Write the queued snapshots and stop the writer thread.
+HistoryWriter::~HistoryWriter() { close(); }
+
+/// Queue a snapshot of the unpadded grid for saving.
+///
+/// @param [in] step The current step number in the simulation.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void HistoryWriter::save(int step, const Entities &entities) {
+  if (!kenabled_) {
+    return;
+  }
+
+  int buffer = acquire_buffer();
+  buffers_[buffer].step = step;
+  copy_unpadded_grid(entities, buffers_[buffer].bacteria, buffers_[buffer].nutrients);
+  submit_buffer(buffer);
+}
+
+/// Queue a snapshot of the unpadded grid for saving.
+///
+/// @param [in] step The current step number in the simulation.
+/// @param [in] bacteria Bacteria states of the unpadded grid, ordered by cell id.
+/// @param [in] nutrients Nutrients states of the unpadded grid, ordered by cell
+///   id.
+void HistoryWriter::save(
+    int step, const component::Bacteria &bacteria,
+    const component::Nutrients &nutrients) {
+  if (!kenabled_) {
+    return;
+  }
+
+  int buffer = acquire_buffer();
+  buffers_[buffer].step = step;
+  buffers_[buffer].bacteria = bacteria;
+  buffers_[buffer].nutrients = nutrients;
+  submit_buffer(buffer);
+}
+
+/// Wait for the writer thread to save every queued snapshot, then finish the
+/// history file.
+///
+/// The wait is counted as stall time. Calling close more than once has no
+/// effect.
+void HistoryWriter::close() {
+  if (!kenabled_ || closed_) {
+    return;
+  }
+
+  auto start = read_timer();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  buffer_queued_.notify_one();
+  thread_.join();
+  stall_time_ += std::chrono::duration<double>(read_timer() - start).count();
+
+  close_history_file(file_, kcli_parameters_, frame_offsets_);
+}
+
+/// Time the simulation spent waiting on the writer thread.
+///
+/// @return Stall time in seconds.
+double HistoryWriter::stall_time() const { return stall_time_; }
+
+/// Take a free snapshot buffer, waiting for the writer thread to free one if
+/// needed.
+///
+/// @return Index of the snapshot buffer.
+int HistoryWriter::acquire_buffer() {
+  auto start = read_timer();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  buffer_freed_.wait(lock, [this] { return !free_buffers_.empty(); });
+  int buffer = free_buffers_.back();
+  free_buffers_.pop_back();
+
+  stall_time_ += std::chrono::duration<double>(read_timer() - start).count();
+
+  return buffer;
+}
+
+/// Queue a filled snapshot buffer for the writer thread.
+///
+/// @param [in] buffer Index of the snapshot buffer.
+void HistoryWriter::submit_buffer(int buffer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_buffers_.push_back(buffer);
+  }
+  buffer_queued_.notify_one();
+}
+
+/// Writer thread loop, saves the queued snapshots in order until closed.
+void HistoryWriter::run() {
+  while (true) {
+    int buffer;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      buffer_queued_.wait(lock, [this] { return closed_ || !queued_buffers_.empty(); });
+      if (queued_buffers_.empty()) {
+        return;
+      }
+      buffer = queued_buffers_.front();
+      queued_buffers_.pop_front();
+    }
+
+    write_snapshot(buffers_[buffer]);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_buffers_.push_back(buffer);
+    }
+    buffer_freed_.notify_one();
+  }
+}
+
+/// Save one snapshot in the history format set via the command-line interface,
+/// recording the byte offset of its frame.
+///
+/// @param [in] snapshot Snapshot to save.
+void HistoryWriter::write_snapshot(const Snapshot &snapshot) {
+  open_history_file(file_, kcli_parameters_);
+  if (kcli_parameters_.history_format != "csv") {
+    frame_offsets_.push_back(file_.tellp());
+  }
+
+  if (kcli_parameters_.history_format == "delta") {
+    save_history_to_delta(
+        file_, kcli_parameters_, snapshot.step, snapshot.bacteria, snapshot.nutrients,
+        delta_state_);
+  } else {
+    save_history(
+        file_, kcli_parameters_, snapshot.step, snapshot.bacteria, snapshot.nutrients);
+  }
+}
+}   // namespace utilities
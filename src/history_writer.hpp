@@ -0,0 +1,66 @@
+#ifndef BIOFILM_SIMULATION_HISTORY_WRITER_HPP
+#define BIOFILM_SIMULATION_HISTORY_WRITER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cli.hpp>
+#include <components.hpp>
+#include <data.hpp>
+#include <entities.hpp>
+
+namespace utilities {
+/// Saves simulation history snapshots on a background thread.
+///
+/// Saving a snapshot copies the unpadded grid into one of a fixed number of
+/// buffers and queues it for the writer thread, so the simulation keeps running
+/// while the previous snapshots are formatted and written to disk. When every
+/// buffer is queued or being written, saving blocks until the writer frees one
+/// (backpressure), and the time spent waiting is counted as stall time.
+class HistoryWriter {
+ public:
+  HistoryWriter(const cli_parameters_t &cli_parameters, bool enabled);
+  ~HistoryWriter();
+
+  void save(int step, const Entities &entities);
+  void save(
+      int step, const component::Bacteria &bacteria,
+      const component::Nutrients &nutrients);
+  void close();
+  double stall_time() const;
+
+ private:
+  /// Copy of the unpadded grid at the end of one step.
+  struct Snapshot {
+    int step;                        ///< Step number of snapshot.
+    component::Bacteria bacteria;    ///< Bacteria states, ordered by cell id.
+    component::Nutrients nutrients;  ///< Nutrients states, ordered by cell id.
+  };
+
+  int acquire_buffer();
+  void submit_buffer(int buffer);
+  void run();
+  void write_snapshot(const Snapshot &snapshot);
+
+  const cli_parameters_t &kcli_parameters_;
+  const bool kenabled_;
+  std::ofstream file_;
+  std::vector<uint64_t> frame_offsets_;  ///< Byte offset of every saved frame.
+  data::HistoryDeltaState delta_state_;  ///< Previous frame of delta history.
+  std::vector<Snapshot> buffers_;   ///< Snapshot buffers, one per queue slot.
+  std::vector<int> free_buffers_;   ///< Buffers ready to be filled.
+  std::deque<int> queued_buffers_;  ///< Buffers waiting to be written, in order.
+  std::mutex mutex_;
+  std::condition_variable buffer_queued_;
+  std::condition_variable buffer_freed_;
+  std::thread thread_;
+  bool closed_;
+  double stall_time_;
+};
+}   // namespace utilities
+
+#endif   // BIOFILM_SIMULATION_HISTORY_WRITER_HPP
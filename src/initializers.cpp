@@ -2,25 +2,63 @@
 
 #include <random>
 
+#include <diffusion_system.hpp>
+
 namespace initializers {
+/// Rows and columns of cells per tile of the dirty-tile diffusion engine.
+static const int kDirtyTileSize = 32;
+
 /// Initialize all entities to be used during simulation.
 ///
 /// @param [in] parameters Input parameters used to initialize all entities in
 ///   simulation.
 /// @param [in] indexer Function object for converting entity ids to (row,
 ///   column) indices, and vice-versa.
-/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] bacterium_initializer Function object for initializing bacteria
+///   in first column of unpadded grid.
 /// @return Entities struct with initialized components.
 Entities initialize_entities(
     const data::InitializationParameters &parameters, utilities::IndexConverter &indexer,
-    std::mt19937 &random_engine) {
+    const utilities::CellIdConverter &cell_id_converter,
+    BacteriumRandomInitializer bacterium_initializer) {
+  Entities entities = Entities();
+  initialize_entities(
+      entities, parameters, indexer, cell_id_converter, bacterium_initializer);
+
+  return entities;
+}
+
+/// Initialize all entities in place, reusing the memory of a previous
+/// simulation.
+///
+/// Any entities already stored are removed first. When the grid dimensions are
+/// unchanged, the components are refilled without allocating.
+///
+/// @param [in,out] entities Entities struct to initialize.
+/// @param [in] parameters Input parameters used to initialize all entities in
+///   simulation.
+/// @param [in] indexer Function object for converting entity ids to (row,
+///   column) indices, and vice-versa.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into cell ids.
+/// @param [in] bacterium_initializer Function object for initializing bacteria
+///   in first column of unpadded grid.
+void initialize_entities(
+    Entities &entities, const data::InitializationParameters &parameters,
+    utilities::IndexConverter &indexer,
+    const utilities::CellIdConverter &cell_id_converter,
+    BacteriumRandomInitializer bacterium_initializer) {
 
   int number_entities = utilities::count_elements(parameters.dimensions);
-  Entities entities = Entities();
+  entities.clear();
+  entities.dimensions_ = parameters.dimensions;
+  entities.with_metadata_ = parameters.with_metadata;
   entities.reserve(number_entities);
 
-  EntityInitializer entity_initializer = EntityInitializer(
-      random_engine, parameters.probability_bacterium, parameters.max_nutrient, entities);
+  EntityInitializer entity_initializer =
+      EntityInitializer(bacterium_initializer, parameters.max_nutrient, entities);
 
   data::CellLocationParameters cell_location_parameters{};
   cell_location_parameters.left_padding_boundary = parameters.dimensions.size_padding;
@@ -33,26 +71,90 @@ Entities initialize_entities(
   for (int i = 0; i < number_entities; i++) {
     cell_location_parameters.index = indexer(i);
     int cell_location = utilities::get_cell_location(cell_location_parameters);
-    Entities::EntityID entity_id =
-        entity_initializer(data::EntityInitializationParameters{
-            cell_location_parameters.index, cell_location});
+    int cell_id = cell_id_converter(cell_location_parameters.index);
+    entity_initializer(data::EntityInitializationParameters{
+        cell_location_parameters.index, cell_location, cell_id});
   }
 
-  return entities;
+  // Bitboards are filled in from the bacteria_copy component each step.
+  int number_padded_rows =
+      parameters.dimensions.number_rows + 2 * parameters.dimensions.size_padding;
+  entities.empty_cells_.assign(number_padded_rows * entities.words_per_row(), 0u);
+  entities.live_cells_.assign(number_padded_rows * entities.words_per_row(), 0u);
+}
+
+/// Initialize all entities using a Mersenne Twister engine.
+///
+/// @param [in] parameters Input parameters used to initialize all entities in
+///   simulation.
+/// @param [in] indexer Function object for converting entity ids to (row,
+///   column) indices, and vice-versa.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// @return Entities struct with initialized components.
+Entities initialize_entities(
+    const data::InitializationParameters &parameters, utilities::IndexConverter &indexer,
+    std::mt19937 &random_engine) {
+  return initialize_entities(
+      parameters, indexer, utilities::CellIdConverter(parameters.dimensions),
+      BacteriumRandomInitializer(random_engine, parameters.probability_bacterium));
+}
+
+/// Initialize all entities using a counter-based random number generator.
+///
+/// @param [in] parameters Input parameters used to initialize all entities in
+///   simulation.
+/// @param [in] indexer Function object for converting entity ids to (row,
+///   column) indices, and vice-versa.
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] cell_id_converter Function object for converting (row, column)
+///   indices into the cell ids used as random number counters.
+/// @return Entities struct with initialized components.
+Entities initialize_entities(
+    const data::InitializationParameters &parameters, utilities::IndexConverter &indexer,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter) {
+  return initialize_entities(
+      parameters, indexer, cell_id_converter,
+      BacteriumRandomInitializer(counter_rng, parameters.probability_bacterium));
+}
+
+/// Collect the live bacteria for the frontier growth engine.
+///
+/// All live bacteria start out in the frontier. The ones without an empty
+/// neighbor are moved to the interior during the first growth phase.
+///
+/// @param [in] entities Entities struct with initialized components.
+/// @return ActiveCells struct listing the live bacteria.
+data::ActiveCells initialize_active_cells(const Entities &entities) {
+  data::ActiveCells active_cells;
+  int cells_per_row = entities.cells_per_row();
+
+  for (int row = entities.first_unpadded_row(); row <= entities.last_unpadded_row();
+       row++) {
+    for (int column = entities.first_unpadded_column();
+         column <= entities.last_unpadded_column(); column++) {
+      Entities::EntityID id = row * cells_per_row + column;
+      if (entities.bacteria_[id] == Entities::kStateBacterium) {
+        active_cells.frontier.push_back(id);
+      }
+    }
+  }
+  active_cells.targets.assign(active_cells.frontier.size(), -1);
+
+  return active_cells;
 }
 
 /// EntityInitializer constructor
 ///
-/// @param [in] random_engine Mersenne Twister engine for random number.
-/// @param [in] probability  Probability to create a bacterium in first column
-///   in the regular, unpadded grid.
+/// @param [in] bacterium_initializer Function object for initializing bacteria
+///   in first column of unpadded grid.
 /// @param [in] max_nutrient Initial fill value for nutrients component.
 /// @param [in] entities Entities struct with uninitialized components.
 EntityInitializer::EntityInitializer(
-    std::mt19937 &random_engine, double probability, double max_nutrient,
+    BacteriumRandomInitializer bacterium_initializer, double max_nutrient,
     Entities &entities)
     : entities_(entities), max_nutrient_(max_nutrient),
-      kbacterium_initializer_(BacteriumRandomInitializer(random_engine, probability)){};
+      kbacterium_initializer_(bacterium_initializer){};
 
 /// Create a new entity and initialize its components.
 ///
@@ -63,105 +165,68 @@ Entities::EntityID EntityInitializer::
 operator()(data::EntityInitializationParameters parameters) {
   int id = -1;
 
-  // Initialize entity in left padding region.
+  // Components are double buffered, so the bacteria and nutrients components
+  // and their copies start out with the same values.
+
   switch (parameters.cell_location) {
+    // Initialize entity in left padding region.
     case utilities::kCellLocationLeftPad:
       id = entities_.add_entity("LeftPad");
+      entities_.bacteria_[id] = Entities::kStateBorder;
       entities_.bacteria_copy_[id] = Entities::kStateBorder;
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationLeftPad;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
       break;
 
     // Initialize entity in right padding region.
     case utilities::kCellLocationRightPad:
       id = entities_.add_entity("RightPad");
+      entities_.bacteria_[id] = Entities::kStateBorder;
+      entities_.nutrients_[id] = max_nutrient_;
       entities_.bacteria_copy_[id] = Entities::kStateBorder;
       entities_.nutrients_copy_[id] = max_nutrient_;
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationRightPad;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
       break;
 
     // Initialize entity in top padding region.
     case utilities::kCellLocationTopPad:
       id = entities_.add_entity("TopPad");
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationTopPad;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
       break;
 
     // Initialize entity in bottom padding region.
     case utilities::kCellLocationBottomPad:
       id = entities_.add_entity("BottomPad");
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationBottomPad;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
       break;
 
     // Initialize entity in first column of regular, unpadded grid.
     case utilities::kCellLocationFirstColumn:
       id = entities_.add_entity("Cell");
-      entities_.bacteria_[id] = kbacterium_initializer_();
+      entities_.bacteria_[id] = kbacterium_initializer_(parameters.cell_id);
       entities_.nutrients_[id] = max_nutrient_;
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationFirstColumn;
-      entities_.flags_[id] |= Entities::kFlagBacteria;
-      entities_.flags_[id] |= Entities::kFlagNutrients;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
+      entities_.bacteria_copy_[id] = entities_.bacteria_[id];
+      entities_.nutrients_copy_[id] = max_nutrient_;
       break;
 
     // Initialize entity in last column of regular, unpadded grid.
     case utilities::kCellLocationLastColumn:
       id = entities_.add_entity("Cell");
       entities_.nutrients_[id] = max_nutrient_;
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationLastColumn;
-      entities_.flags_[id] |= Entities::kFlagBacteria;
-      entities_.flags_[id] |= Entities::kFlagNutrients;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
+      entities_.nutrients_copy_[id] = max_nutrient_;
       break;
 
     // Initialize entity in regular, unpadded grid.
     case utilities::kCellLocationOther:
       id = entities_.add_entity("cell");
       entities_.nutrients_[id] = max_nutrient_;
-      entities_.indices_[id].row = parameters.index.row;
-      entities_.indices_[id].column = parameters.index.column;
-      entities_.locations_[id] = utilities::kCellLocationOther;
-      entities_.flags_[id] |= Entities::kFlagBacteria;
-      entities_.flags_[id] |= Entities::kFlagNutrients;
-      entities_.flags_[id] |= Entities::kFlagBacteriaCopy;
-      entities_.flags_[id] |= Entities::kFlagNutrientsCopy;
-      entities_.flags_[id] |= Entities::kFlagCellIndices;
-      entities_.flags_[id] |= Entities::kFlagCellLocations;
+      entities_.nutrients_copy_[id] = max_nutrient_;
       break;
   }
 
+  // Metadata mirrors what the grid geometry already implies, so it is only
+  // filled in for the debugging helpers.
+  if (entities_.with_metadata_) {
+    entities_.indices_[id] = parameters.index;
+    entities_.locations_[id] = parameters.cell_location;
+    entities_.flags_[id] = entities_.active_components(id);
+  }
+
   return id;
 }
 
@@ -172,18 +237,35 @@ operator()(data::EntityInitializationParameters parameters) {
 /// in the regular, unpadded grid.
 BacteriumRandomInitializer::BacteriumRandomInitializer(
     std::mt19937 &random_engine, double probability)
-    : random_engine_(random_engine), uniform_rng_(UniformRNG(0.0, 1.0)),
-      probability_(probability){};
+    : random_engine_(&random_engine), counter_rng_(nullptr),
+      uniform_rng_(UniformRNG(0.0, 1.0)), probability_(probability){};
+
+/// BacteriumRandomInitializer constructor
+///
+/// @param [in] counter_rng Counter-based random number generator.
+/// @param [in] probability  Probability to create a bacterium in first column
+/// in the regular, unpadded grid.
+BacteriumRandomInitializer::BacteriumRandomInitializer(
+    const rng::CounterRNG &counter_rng, double probability)
+    : random_engine_(nullptr), counter_rng_(&counter_rng),
+      uniform_rng_(UniformRNG(0.0, 1.0)), probability_(probability){};
 
 /// Initialize bacterium cell in first column of unpadded grid.
 ///
 /// A random number is generated and checked against a probability. If the
 /// random number is smaller than the probability, then a bacterium is created
-/// in the cell.
+/// in the cell. A counter-based generator draws the number for step 0 of the
+/// given cell, a Mersenne Twister engine draws the next number in its stream.
 ///
+/// @param [in] cell_id Cell id of entity in regular, unpadded grid.
 /// @return Randomly selected bacterium state
-int BacteriumRandomInitializer::operator()() {
-  double random_number = uniform_rng_(random_engine_);
+int BacteriumRandomInitializer::operator()(int cell_id) {
+  double random_number;
+  if (counter_rng_ != nullptr) {
+    random_number = (*counter_rng_)(0u, cell_id, rng::kDrawInitialize);
+  } else {
+    random_number = uniform_rng_(*random_engine_);
+  }
 
   if (random_number < probability_) {
     return Entities::kStateBacterium;
@@ -192,4 +274,196 @@ int BacteriumRandomInitializer::operator()() {
   }
 }
 
+/// Split the grid into tiles for the dirty-tile diffusion engine.
+///
+/// Every tile starts out dirty, so the first diffusion phase updates the whole
+/// grid.
+///
+/// @param [in] entities Entities struct with initialized components.
+/// @return DirtyTiles struct with every tile marked as changed.
+data::DirtyTiles initialize_dirty_tiles(const Entities &entities) {
+  data::DirtyTiles dirty_tiles;
+  dirty_tiles.tile_size = kDirtyTileSize;
+  dirty_tiles.tile_rows =
+      (entities.dimensions_.number_rows + kDirtyTileSize - 1) / kDirtyTileSize;
+  dirty_tiles.tile_columns =
+      (entities.dimensions_.number_columns + kDirtyTileSize - 1) / kDirtyTileSize;
+  dirty_tiles.changed.assign(dirty_tiles.tile_rows * dirty_tiles.tile_columns, 1);
+  dirty_tiles.dirty.assign(dirty_tiles.tile_rows * dirty_tiles.tile_columns, 1);
+
+  return dirty_tiles;
+}
+
+/// Eliminate the lower diagonal of a tridiagonal system whose off-diagonals
+/// are all the same, the forward sweep of the Thomas algorithm.
+///
+/// @param [in] diagonal Diagonal of the system.
+/// @param [in] off_diagonal Value of every entry on the upper and lower
+///   diagonals.
+/// @param [out] upper Upper diagonal of the eliminated system.
+/// @param [out] scale Inverse diagonal of the eliminated system.
+static void eliminate_tridiagonal(
+    const std::vector<double> &diagonal, double off_diagonal, std::vector<double> &upper,
+    std::vector<double> &scale) {
+  int size = diagonal.size();
+  upper.assign(size, 0.0);
+  scale.assign(size, 0.0);
+
+  for (int index = 0; index < size; index++) {
+    double pivot = diagonal[index];
+    if (index > 0) {
+      pivot -= off_diagonal * upper[index - 1];
+    }
+    scale[index] = 1.0 / pivot;
+    upper[index] = off_diagonal * scale[index];
+  }
+}
+
+/// Precompute the coefficients of the tridiagonal systems of the implicit
+/// diffusion engine.
+///
+/// Each direction takes one backward Euler step with three times the diffusion
+/// rate per neighbor, the rate at which the explicit Moore stencil spreads
+/// nutrients along a row or column, so both engines agree for small rates.
+///
+/// @param [in] entities Entities struct with initialized components.
+/// @param [in] diffusion_rate Diffusion rate for nutrients.
+/// @param [in] num_threads Number of threads running the engine.
+/// @return ImplicitDiffusion struct for the grid's dimensions.
+data::ImplicitDiffusion initialize_implicit_diffusion(
+    const Entities &entities, double diffusion_rate, int num_threads) {
+  int number_rows = entities.dimensions_.number_rows;
+  int number_columns = entities.dimensions_.number_columns;
+  double coupling = 3.0 * diffusion_rate;
+  double diagonal = 1.0 + 2.0 * coupling;
+  std::vector<double> upper;
+  std::vector<double> scale;
+
+  data::ImplicitDiffusion implicit_diffusion;
+  implicit_diffusion.coupling = coupling;
+
+  eliminate_tridiagonal(
+      std::vector<double>(number_columns, diagonal), -coupling, upper, scale);
+  implicit_diffusion.row_upper.assign(upper.begin(), upper.end());
+  implicit_diffusion.row_scale.assign(scale.begin(), scale.end());
+
+  // The cyclic column system equals a tridiagonal system with its first and
+  // last diagonal entries shifted, plus the outer product of the correction
+  // (gamma, 0, ..., 0, -coupling) and (1, 0, ..., 0, coupling / diagonal)
+  double gamma = -diagonal;
+  double corner = coupling / diagonal;
+  std::vector<double> column_diagonal(number_rows, diagonal);
+  column_diagonal[0] -= gamma;
+  column_diagonal[number_rows - 1] += coupling * corner;
+  eliminate_tridiagonal(column_diagonal, -coupling, upper, scale);
+  implicit_diffusion.column_upper.assign(upper.begin(), upper.end());
+  implicit_diffusion.column_scale.assign(scale.begin(), scale.end());
+
+  std::vector<double> correction(number_rows, 0.0);
+  correction[0] = gamma;
+  correction[number_rows - 1] -= coupling;
+  for (int index = 0; index < number_rows; index++) {
+    double previous = index > 0 ? correction[index - 1] : 0.0;
+    correction[index] = (correction[index] + coupling * previous) * scale[index];
+  }
+  for (int index = number_rows - 2; index >= 0; index--) {
+    correction[index] -= upper[index] * correction[index + 1];
+  }
+  implicit_diffusion.column_correction.assign(correction.begin(), correction.end());
+  implicit_diffusion.correction_corner = corner;
+  implicit_diffusion.correction_scale =
+      1.0 / (1.0 + correction[0] + corner * correction[number_rows - 1]);
+
+  implicit_diffusion.batch_values = transformers::get_implicit_batch_values(entities);
+  implicit_diffusion.batches.assign(num_threads * implicit_diffusion.batch_values, 0.0);
+
+  return implicit_diffusion;
+}
+
+/// Size the tiles and allocate the scratch buffers of the blocked diffusion
+/// engine.
+///
+/// @param [in] entities Entities struct with initialized components.
+/// @param [in] substeps Number of diffusion substeps per time step.
+/// @param [in] num_threads Number of threads running the engine.
+/// @return BlockedDiffusion struct for the grid's dimensions.
+data::BlockedDiffusion
+initialize_blocked_diffusion(const Entities &entities, int substeps, int num_threads) {
+  data::BlockedDiffusion blocked_diffusion;
+  blocked_diffusion.tile_rows = transformers::get_blocked_tile_rows(entities, substeps);
+  blocked_diffusion.buffer_values =
+      (blocked_diffusion.tile_rows + 2 * substeps) * entities.cells_per_row();
+  blocked_diffusion.scratch.assign(
+      2 * num_threads * blocked_diffusion.buffer_values, 0.0);
+
+  return blocked_diffusion;
+}
+
+/// Allocate the interleaved components of an ensemble of replicas.
+///
+/// When the grid dimensions and number of lanes are unchanged, the components
+/// are refilled without allocating. The lanes are filled in afterwards with
+/// initialize_ensemble_lane.
+///
+/// @param [in,out] ensemble EnsembleEntities struct to allocate.
+/// @param [in] dimensions Dimensions of the grid every replica is laid out on.
+/// @param [in] lanes Number of replicas.
+void initialize_ensemble_entities(
+    EnsembleEntities &ensemble, const data::Dimensions &dimensions, int lanes) {
+  int number_entities = utilities::count_elements(dimensions);
+  int number_values = number_entities * lanes;
+  ensemble.dimensions_ = dimensions;
+  ensemble.lanes_ = lanes;
+  ensemble.bacteria_.assign(number_values, Entities::kStateEmpty);
+  ensemble.nutrients_.assign(number_values, 0.0);
+  ensemble.bacteria_copy_.assign(number_values, Entities::kStateEmpty);
+  ensemble.nutrients_copy_.assign(number_values, 0.0);
+  ensemble.live_lanes_.assign(number_entities, 0u);
+  ensemble.empty_lanes_.assign(number_entities, 0u);
+  ensemble.birth_lanes_.assign(number_entities, 0u);
+  int number_padded_rows = dimensions.number_rows + 2 * dimensions.size_padding;
+  ensemble.live_cells_.assign(number_padded_rows * ensemble.words_per_row(), 0u);
+  ensemble.birth_cells_.assign(number_padded_rows * ensemble.words_per_row(), 0u);
+}
+
+/// Fill one lane of an ensemble with the states of a single replica.
+///
+/// The replica is initialized by the usual initializers, so every lane starts
+/// out exactly as a single simulation with the same seed would. The lane's
+/// bits of the live and empty lane masks, and the live cells bitboard, are set
+/// from the bacteria states of its unpadded cells.
+///
+/// @param [in,out] ensemble EnsembleEntities struct allocated for the grid
+///   dimensions of the replica.
+/// @param [in] lane Lane to fill.
+/// @param [in] entities Entities struct with initialized components.
+void initialize_ensemble_lane(
+    EnsembleEntities &ensemble, int lane, const Entities &entities) {
+  int lanes = ensemble.lanes_;
+  int number_entities = entities.size();
+
+  for (int id = 0; id < number_entities; id++) {
+    ensemble.bacteria_[id * lanes + lane] = entities.bacteria_[id];
+    ensemble.nutrients_[id * lanes + lane] = entities.nutrients_[id];
+    ensemble.bacteria_copy_[id * lanes + lane] = entities.bacteria_copy_[id];
+    ensemble.nutrients_copy_[id * lanes + lane] = entities.nutrients_copy_[id];
+  }
+
+  int cells_per_row = ensemble.cells_per_row();
+  int words_per_row = ensemble.words_per_row();
+  for (int row = ensemble.first_unpadded_row(); row <= ensemble.last_unpadded_row();
+       row++) {
+    for (int column = ensemble.first_unpadded_column();
+         column <= ensemble.last_unpadded_column(); column++) {
+      int id = row * cells_per_row + column;
+      if (entities.bacteria_[id] == Entities::kStateBacterium) {
+        ensemble.live_lanes_[id] |= 1ull << lane;
+        ensemble.live_cells_[row * words_per_row + column / 64] |= 1ull << (column % 64);
+      } else if (entities.bacteria_[id] == Entities::kStateEmpty) {
+        ensemble.empty_lanes_[id] |= 1ull << lane;
+      }
+    }
+  }
+}
+
 }   // namespace initializers
@@ -3,19 +3,23 @@
 
 #include <random>
 
+#include <ensemble_entities.hpp>
 #include <entities.hpp>
+#include <rng.hpp>
 #include <utilities.hpp>
 
 namespace initializers {
 struct BacteriumRandomInitializer {
   using UniformRNG = std::uniform_real_distribution<double>;
 
-  std::mt19937 &random_engine_;
+  std::mt19937 *random_engine_;
+  const rng::CounterRNG *counter_rng_;
   UniformRNG uniform_rng_;
   double probability_;
 
   BacteriumRandomInitializer(std::mt19937 &random_engine, double probability);
-  int operator()();
+  BacteriumRandomInitializer(const rng::CounterRNG &counter_rng, double probability);
+  int operator()(int cell_id);
 };
 
 struct EntityInitializer {
@@ -27,14 +31,37 @@ public:
   BacteriumRandomInitializer kbacterium_initializer_;
 
   EntityInitializer(
-      std::mt19937 &random_engine, double probability, double max_nutrient,
+      BacteriumRandomInitializer bacterium_initializer, double max_nutrient,
       Entities &entities);
   Entities::EntityID operator()(data::EntityInitializationParameters parameters);
 };
 
+Entities initialize_entities(
+    const data::InitializationParameters &parameters, utilities::IndexConverter &indexer,
+    const utilities::CellIdConverter &cell_id_converter,
+    BacteriumRandomInitializer bacterium_initializer);
+void initialize_entities(
+    Entities &entities, const data::InitializationParameters &parameters,
+    utilities::IndexConverter &indexer,
+    const utilities::CellIdConverter &cell_id_converter,
+    BacteriumRandomInitializer bacterium_initializer);
 Entities initialize_entities(
     const data::InitializationParameters &parameters, utilities::IndexConverter &indexer,
     std::mt19937 &random_engine);
+Entities initialize_entities(
+    const data::InitializationParameters &parameters, utilities::IndexConverter &indexer,
+    const rng::CounterRNG &counter_rng,
+    const utilities::CellIdConverter &cell_id_converter);
+data::ActiveCells initialize_active_cells(const Entities &entities);
+data::DirtyTiles initialize_dirty_tiles(const Entities &entities);
+data::ImplicitDiffusion initialize_implicit_diffusion(
+    const Entities &entities, double diffusion_rate, int num_threads);
+data::BlockedDiffusion
+initialize_blocked_diffusion(const Entities &entities, int substeps, int num_threads);
+void initialize_ensemble_entities(
+    EnsembleEntities &ensemble, const data::Dimensions &dimensions, int lanes);
+void initialize_ensemble_lane(
+    EnsembleEntities &ensemble, int lane, const Entities &entities);
 
 }   // namespace initializers
 
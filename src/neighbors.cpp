@@ -1,83 +1,50 @@
 #include <neighbors.hpp>
 
+#include <algorithm>
+#include <array>
 #include <random>
 
 #include <data.hpp>
 #include <entities.hpp>
 
 namespace neighbors {
-/// Get ids for von Neumann neighborhood for entity in first column of 2D grid.
+/// Slots of the set bits in each 4-bit empty-neighbor mask, in ascending order.
+/// Slots follow get_bacterium_neighbors: 0 west, 1 east, 2 north, 3 south.
+static const std::array<std::array<int, 4>, 16> kEmptyNeighborSlots{{
+    {{-1, -1, -1, -1}},
+    {{0, -1, -1, -1}},
+    {{1, -1, -1, -1}},
+    {{0, 1, -1, -1}},
+    {{2, -1, -1, -1}},
+    {{0, 2, -1, -1}},
+    {{1, 2, -1, -1}},
+    {{0, 1, 2, -1}},
+    {{3, -1, -1, -1}},
+    {{0, 3, -1, -1}},
+    {{1, 3, -1, -1}},
+    {{0, 1, 3, -1}},
+    {{2, 3, -1, -1}},
+    {{0, 2, 3, -1}},
+    {{1, 2, 3, -1}},
+    {{0, 1, 2, 3}},
+}};
+
+/// Find the north and south neighbor shifts of the cells in one row.
 ///
-/// When finding neighbors, the boundary conditions are as follows,
-/// * West and east boundary: treated as hard boundary, no neighbors
-/// * North and south boundary: treated as periodic boundary
-///
-/// @param [in] id Identifies entity whose neighbors you want to find.
-/// @param [in] entities Entities struct with components defining the
-///   nutrients and bacteria grids.
+/// @param [in] row Row index of the row in the padded grid.
 /// @param [in] parameters Input data used for finding neighboring sites.
-/// @return Array of entity ids in von Neumann neighborhood
-data::ThreeNeighborIDs get_first_column_bacterium_neighbors(
-    Entities::EntityID id, const Entities &entities,
-    const data::GetNeighborsParameters &parameters) {
-  data::ThreeNeighborIDs neighborhood{};
-
-  int top_neighbor;
-  if (entities.indices_[id].row == parameters.first_unpadded_row) {
-    top_neighbor = id + parameters.wraparound_shift;
+PeriodicRows::PeriodicRows(int row, const data::GetNeighborsParameters &parameters) {
+  if (row == parameters.first_unpadded_row) {
+    north_shift = parameters.wraparound_shift;
   } else {
-    top_neighbor = id - parameters.cells_per_row;
+    north_shift = -parameters.cells_per_row;
   }
 
-  int bottom_neighbor;
-  if (entities.indices_[id].row == parameters.last_unpadded_row) {
-    bottom_neighbor = id - parameters.wraparound_shift;
+  if (row == parameters.last_unpadded_row) {
+    south_shift = -parameters.wraparound_shift;
   } else {
-    bottom_neighbor = id + parameters.cells_per_row;
+    south_shift = parameters.cells_per_row;
   }
-
-  neighborhood[0] = id + 1;
-  neighborhood[1] = top_neighbor;
-  neighborhood[2] = bottom_neighbor;
-
-  return neighborhood;
-}
-
-/// Get ids for von Neumann neighborhood for entity in last column of 2D grid.
-///
-/// When finding neighbors, the boundary conditions are as follows,
-/// * West and east boundary: treated as hard boundary, no neighbors
-/// * North and south boundary: treated as periodic boundary
-///
-/// @param [in] id Identifies entity whose neighbors you want to find.
-/// @param [in] entities Entities struct with components defining the
-///   nutrients and bacteria grids.
-/// @param [in] parameters Input data used for finding neighboring sites.
-/// @return Array of entity ids in von Neumann neighborhood
-data::ThreeNeighborIDs get_last_column_bacterium_neighbors(
-    Entities::EntityID id, const Entities &entities,
-    const data::GetNeighborsParameters &parameters) {
-  data::ThreeNeighborIDs neighborhood{};
-
-  int top_neighbor;
-  if (entities.indices_[id].row == parameters.first_unpadded_row) {
-    top_neighbor = id + parameters.wraparound_shift;
-  } else {
-    top_neighbor = id - parameters.cells_per_row;
-  }
-
-  int bottom_neighbor;
-  if (entities.indices_[id].row == parameters.last_unpadded_row) {
-    bottom_neighbor = id - parameters.wraparound_shift;
-  } else {
-    bottom_neighbor = id + parameters.cells_per_row;
-  }
-
-  neighborhood[0] = id - 1;
-  neighborhood[1] = top_neighbor;
-  neighborhood[2] = bottom_neighbor;
-
-  return neighborhood;
 }
 
 /// Get ids for von Neumann neighborhood for an entity on the 2D grid.
@@ -96,15 +63,17 @@ data::FourNeighborIDs get_bacterium_neighbors(
     const data::GetNeighborsParameters &parameters) {
   data::FourNeighborIDs neighborhood{};
 
+  int row = id / parameters.cells_per_row;
+
   int top_neighbor;
-  if (entities.indices_[id].row == parameters.first_unpadded_row) {
+  if (row == parameters.first_unpadded_row) {
     top_neighbor = id + parameters.wraparound_shift;
   } else {
     top_neighbor = id - parameters.cells_per_row;
   }
 
   int bottom_neighbor;
-  if (entities.indices_[id].row == parameters.last_unpadded_row) {
+  if (row == parameters.last_unpadded_row) {
     bottom_neighbor = id - parameters.wraparound_shift;
   } else {
     bottom_neighbor = id + parameters.cells_per_row;
@@ -135,15 +104,17 @@ data::EightNeighborIDs get_nutrient_neighbor_ids(
     const data::GetNeighborsParameters &parameters) {
   data::EightNeighborIDs neighborhood{};
 
+  int row = id / parameters.cells_per_row;
+
   int top_neighbor;
-  if (entities.indices_[id].row == parameters.first_unpadded_row) {
+  if (row == parameters.first_unpadded_row) {
     top_neighbor = id + parameters.wraparound_shift;
   } else {
     top_neighbor = id - parameters.cells_per_row;
   }
 
   int bottom_neighbor;
-  if (entities.indices_[id].row == parameters.last_unpadded_row) {
+  if (row == parameters.last_unpadded_row) {
     bottom_neighbor = id - parameters.wraparound_shift;
   } else {
     bottom_neighbor = id + parameters.cells_per_row;
@@ -190,6 +161,15 @@ int sample_random_id(int num_neighbors, std::mt19937 &random_engine) {
   return neighbor_rng(random_engine);
 }
 
+/// Sample an array index using a given random number.
+///
+/// @param num_neighbors The number of neighbors you are selecting from.
+/// @param [in] random_number Uniform random number in the range [0.0, 1.0).
+/// @return Integer for indexing into neighbor ids array.
+int sample_random_id(int num_neighbors, double random_number) {
+  return std::min(static_cast<int>(random_number * num_neighbors), num_neighbors - 1);
+}
+
 /// Check if entity's bacteria component has an empty neighbor in von Neumann
 /// neighborhood.
 ///
@@ -201,41 +181,40 @@ int sample_random_id(int num_neighbors, std::mt19937 &random_engine) {
 bool check_for_empty_neighbors(
     Entities::EntityID id, const Entities &entities,
     const data::GetNeighborsParameters &parameters) {
-  int cell_location = entities.locations_[id];
-
-  bool empty_state_detected = false;
-  if (cell_location == utilities::kCellLocationFirstColumn) {
-    data::ThreeNeighborIDs neighborhood =
-        get_first_column_bacterium_neighbors(id, entities, parameters);
-    for (int i = 0; i < 3; i++) {
-      int neighbor_id = neighborhood[i];
-      int state = entities.bacteria_copy_[neighbor_id];
-      if (state == Entities::kStateEmpty) {
-        empty_state_detected = true;
-      }
-    }
-  } else if (cell_location == utilities::kCellLocationLastColumn) {
-    data::ThreeNeighborIDs neighborhood =
-        get_last_column_bacterium_neighbors(id, entities, parameters);
-    for (int i = 0; i < 3; i++) {
-      int neighbor_id = neighborhood[i];
-      int state = entities.bacteria_copy_[neighbor_id];
-      if (state == Entities::kStateEmpty) {
-        empty_state_detected = true;
-      }
-    }
+  data::FourNeighborIDs empty_neighbor_ids{};
+
+  return collect_empty_neighbors(id, entities, parameters, empty_neighbor_ids) > 0;
+}
+
+/// Collect the empty neighbors in von Neumann neighborhood.
+///
+/// Picks the boundary policies of the entity's row and column, for callers that
+/// visit cells one at a time rather than in sweeps over a range of columns.
+///
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] parameters Input data used for finding neighboring sites.
+/// @param [out] empty_neighbor_ids Array filled with entity ids of empty
+///   neighbors.
+/// @return Number of empty neighbors found.
+int collect_empty_neighbors(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters,
+    data::FourNeighborIDs &empty_neighbor_ids) {
+  int column = id % parameters.cells_per_row;
+  PeriodicRows row_policy(id / parameters.cells_per_row, parameters);
+
+  if (column == parameters.first_unpadded_column) {
+    return collect_empty_neighbors<FirstColumn>(
+        id, entities, row_policy, empty_neighbor_ids);
+  } else if (column == parameters.last_unpadded_column) {
+    return collect_empty_neighbors<LastColumn>(
+        id, entities, row_policy, empty_neighbor_ids);
   } else {
-    data::FourNeighborIDs neighborhood =
-        get_bacterium_neighbors(id, entities, parameters);
-    for (int i = 0; i < 4; i++) {
-      int neighbor_id = neighborhood[i];
-      int state = entities.bacteria_copy_[neighbor_id];
-      if (state == Entities::kStateEmpty) {
-        empty_state_detected = true;
-      }
-    }
+    return collect_empty_neighbors<InteriorColumns>(
+        id, entities, row_policy, empty_neighbor_ids);
   }
-  return empty_state_detected;
 }
 
 /// Pick an empty neighbor in von Neumann neighborhood at random.
@@ -249,43 +228,146 @@ bool check_for_empty_neighbors(
 Entities::EntityID pick_bacterium_neighbor(
     Entities::EntityID id, const Entities &entities,
     const data::GetNeighborsParameters &parameters, std::mt19937 &random_engine) {
-  int cell_location = entities.locations_[id];
   data::FourNeighborIDs empty_neighbor_ids{};
-  int number_empty_neighbors = 0;
-
-  if (cell_location == utilities::kCellLocationFirstColumn) {
-    data::ThreeNeighborIDs neighborhood =
-        get_first_column_bacterium_neighbors(id, entities, parameters);
-    for (int i = 0; i < 3; i++) {
-      int state = entities.bacteria_copy_[neighborhood[i]];
-      if (state == Entities::kStateEmpty) {
-        empty_neighbor_ids[number_empty_neighbors] = neighborhood[i];
-        number_empty_neighbors++;
-      }
-    }
-  } else if (cell_location == utilities::kCellLocationLastColumn) {
-    data::ThreeNeighborIDs neighborhood =
-        get_last_column_bacterium_neighbors(id, entities, parameters);
-    for (int i = 0; i < 3; i++) {
-      int state = entities.bacteria_copy_[neighborhood[i]];
-      if (state == Entities::kStateEmpty) {
-        empty_neighbor_ids[number_empty_neighbors] = neighborhood[i];
-        number_empty_neighbors++;
-      }
-    }
-  } else {
-    data::FourNeighborIDs neighborhood =
-        get_bacterium_neighbors(id, entities, parameters);
-    for (int i = 0; i < 4; i++) {
-      int state = entities.bacteria_copy_[neighborhood[i]];
-      if (state == Entities::kStateEmpty) {
-        empty_neighbor_ids[number_empty_neighbors] = neighborhood[i];
-        number_empty_neighbors++;
-      }
-    }
-  }
+  int number_empty_neighbors =
+      collect_empty_neighbors(id, entities, parameters, empty_neighbor_ids);
   int selected_neighbor = sample_random_id(number_empty_neighbors, random_engine);
 
   return empty_neighbor_ids[selected_neighbor];
 }
+
+/// Pick an empty neighbor in von Neumann neighborhood using a given random
+/// number.
+///
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] parameters Input data used for finding neighboring sites.
+/// @param [in] random_number Uniform random number in the range [0.0, 1.0).
+/// @return Entity id of randomly selected empty neighbor.
+Entities::EntityID pick_bacterium_neighbor(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters, double random_number) {
+  data::FourNeighborIDs empty_neighbor_ids{};
+  int number_empty_neighbors =
+      collect_empty_neighbors(id, entities, parameters, empty_neighbor_ids);
+  int selected_neighbor = sample_random_id(number_empty_neighbors, random_number);
+
+  return empty_neighbor_ids[selected_neighbor];
+}
+
+/// Find which of 64 consecutive cells in a row have a neighbor in von Neumann
+/// neighborhood that is set in a bitboard.
+///
+/// The rows above and below come straight from the padded rows of the
+/// bitboard, and the padded columns are never set in the empty and live cell
+/// bitboards.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] cells Bitboard to test, either the empty or live cells.
+/// @param [in] row Row index of the cells in the padded grid.
+/// @param [in] word Index of the 64-bit word holding the cells in the row.
+/// @return Bitfield with a bit set for each cell with a neighbor set in cells.
+uint64_t get_neighbor_word(
+    const Entities &entities, const component::Bitboard &cells, int row, int word) {
+  int words_per_row = entities.words_per_row();
+  const uint64_t *above = &cells[(row - 1) * words_per_row];
+  const uint64_t *center = &cells[row * words_per_row];
+  const uint64_t *below = &cells[(row + 1) * words_per_row];
+
+  // Shift the row's cells one column east and west, carrying the bit across
+  // word boundaries.
+  uint64_t west = center[word] << 1u;
+  uint64_t east = center[word] >> 1u;
+  if (word > 0) {
+    west |= center[word - 1] >> 63u;
+  }
+  if (word < words_per_row - 1) {
+    east |= center[word + 1] << 63u;
+  }
+
+  return west | east | above[word] | below[word];
+}
+
+/// Read the empty neighbors in von Neumann neighborhood from the bitboard.
+///
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @return 4-bit mask with bit 0 set for an empty west neighbor, bit 1 for
+///   east, bit 2 for north, and bit 3 for south.
+int get_empty_neighbor_mask(Entities::EntityID id, const Entities &entities) {
+  int words_per_row = entities.words_per_row();
+  data::Index index = entities.index(id);
+
+  // Bitboard word and bit of the entity's column.
+  int word = index.column / 64;
+  int bit = index.column % 64;
+  const uint64_t *center = &entities.empty_cells_[index.row * words_per_row];
+
+  int west_bit = bit - 1;
+  int west_word = word;
+  if (west_bit < 0) {
+    west_bit = 63;
+    west_word--;
+  }
+
+  int east_bit = bit + 1;
+  int east_word = word;
+  if (east_bit > 63) {
+    east_bit = 0;
+    east_word++;
+  }
+
+  int west = (center[west_word] >> west_bit) & 1u;
+  int east = (center[east_word] >> east_bit) & 1u;
+  int north = (center[word - words_per_row] >> bit) & 1u;
+  int south = (center[word + words_per_row] >> bit) & 1u;
+
+  return west | (east << 1) | (north << 2) | (south << 3);
+}
+
+/// Pick an empty neighbor from a 4-bit empty-neighbor mask at random.
+///
+/// Picks the same neighbor as pick_bacterium_neighbor, since the set bits are
+/// visited in the order collect_empty_neighbors lists the empty neighbors.
+///
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] parameters Input data used for finding neighboring sites.
+/// @param [in] mask Empty-neighbor mask from get_empty_neighbor_mask.
+/// @param [in,out] random_engine Mersenne Twister engine for random number
+/// @return Entity id of randomly selected empty neighbor.
+Entities::EntityID pick_empty_neighbor(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters, int mask,
+    std::mt19937 &random_engine) {
+  int number_empty_neighbors = __builtin_popcount(mask);
+  int selected_neighbor = sample_random_id(number_empty_neighbors, random_engine);
+
+  return get_bacterium_neighbors(
+      id, entities, parameters)[kEmptyNeighborSlots[mask][selected_neighbor]];
+}
+
+/// Pick an empty neighbor from a 4-bit empty-neighbor mask using a given random
+/// number.
+///
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] parameters Input data used for finding neighboring sites.
+/// @param [in] mask Empty-neighbor mask from get_empty_neighbor_mask.
+/// @param [in] random_number Uniform random number in the range [0.0, 1.0).
+/// @return Entity id of randomly selected empty neighbor.
+Entities::EntityID pick_empty_neighbor(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters, int mask, double random_number) {
+  int number_empty_neighbors = __builtin_popcount(mask);
+  int selected_neighbor = sample_random_id(number_empty_neighbors, random_number);
+
+  return get_bacterium_neighbors(
+      id, entities, parameters)[kEmptyNeighborSlots[mask][selected_neighbor]];
+}
 }   // namespace neighbors
@@ -9,12 +9,115 @@
 #include <utilities.hpp>
 
 namespace neighbors {
-data::ThreeNeighborIDs get_first_column_bacterium_neighbors(
-    Entities::EntityID id, const Entities &entities,
-    const data::GetNeighborsParameters &parameters);
-data::ThreeNeighborIDs get_last_column_bacterium_neighbors(
-    Entities::EntityID id, const Entities &entities,
-    const data::GetNeighborsParameters &parameters);
+/// Boundary policies of the von Neumann neighborhood.
+///
+/// Sweeps over a range of cells that share a boundary pick the neighbor lookup
+/// at compile time through these policies, so the lookup in the hot interior
+/// sweep has no per-cell boundary checks. A column policy states which of the
+/// west and east neighbors exist, and a row policy finds the north and south
+/// neighbors of every cell in one row. Other boundaries, such as reflective or
+/// periodic west and east walls, are added as further policies without
+/// touching the interior sweep.
+
+/// Column policy of the interior columns, whose cells have both a west and an
+/// east neighbor.
+struct InteriorColumns {
+  static const bool kHasWest = true;
+  static const bool kHasEast = true;
+};
+
+/// Column policy of the first column, whose west boundary is a hard wall.
+struct FirstColumn {
+  static const bool kHasWest = false;
+  static const bool kHasEast = true;
+};
+
+/// Column policy of the last column, whose east boundary is a hard wall.
+struct LastColumn {
+  static const bool kHasWest = true;
+  static const bool kHasEast = false;
+};
+
+/// Row policy of a grid that wraps around north to south.
+///
+/// The first row's north neighbors are in the last row and the last row's
+/// south neighbors are in the first row, so the wraparound is resolved once
+/// per row.
+struct PeriodicRows {
+  int north_shift;   ///< Entity id shift from a cell to its north neighbor.
+  int south_shift;   ///< Entity id shift from a cell to its south neighbor.
+
+  PeriodicRows(int row, const data::GetNeighborsParameters &parameters);
+};
+
+/// Collect the empty neighbors in von Neumann neighborhood, using boundary
+/// policies known at compile time.
+///
+/// The neighbors are listed west, east, north, south, leaving out the ones the
+/// column policy excludes, in the same order as get_bacterium_neighbors.
+///
+/// @tparam ColumnPolicy Column policy of the entity's column.
+/// @tparam RowPolicy Row policy of the entity's row.
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] row_policy Row policy of the entity's row.
+/// @param [out] empty_neighbor_ids Array filled with entity ids of empty
+///   neighbors.
+/// @return Number of empty neighbors found.
+template <typename ColumnPolicy, typename RowPolicy>
+inline int collect_empty_neighbors(
+    Entities::EntityID id, const Entities &entities, const RowPolicy &row_policy,
+    data::FourNeighborIDs &empty_neighbor_ids) {
+  data::FourNeighborIDs neighborhood{};
+  int number_neighbors = 0;
+  if (ColumnPolicy::kHasWest) {
+    neighborhood[number_neighbors++] = id - 1;
+  }
+  if (ColumnPolicy::kHasEast) {
+    neighborhood[number_neighbors++] = id + 1;
+  }
+  neighborhood[number_neighbors++] = id + row_policy.north_shift;
+  neighborhood[number_neighbors++] = id + row_policy.south_shift;
+
+  int number_empty_neighbors = 0;
+  for (int i = 0; i < number_neighbors; i++) {
+    empty_neighbor_ids[number_empty_neighbors] = neighborhood[i];
+    number_empty_neighbors +=
+        entities.bacteria_copy_[neighborhood[i]] == Entities::kStateEmpty;
+  }
+
+  return number_empty_neighbors;
+}
+
+/// Check if a neighbor in von Neumann neighborhood divides into entity, using
+/// boundary policies known at compile time.
+///
+/// @tparam ColumnPolicy Column policy of the entity's column.
+/// @tparam RowPolicy Row policy of the entity's row.
+/// @param [in] id Identifies entity whose neighbors you want to check.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] row_policy Row policy of the entity's row.
+/// @param [in] cell_id Cell id of entity in regular, unpadded grid.
+/// @return Boolean for whether or not a neighbor divides into entity.
+template <typename ColumnPolicy, typename RowPolicy>
+inline bool check_for_dividing_neighbors(
+    Entities::EntityID id, const Entities &entities, const RowPolicy &row_policy,
+    int cell_id) {
+  bool division_detected = false;
+  if (ColumnPolicy::kHasWest) {
+    division_detected |= entities.divisions_[id - 1] == cell_id;
+  }
+  if (ColumnPolicy::kHasEast) {
+    division_detected |= entities.divisions_[id + 1] == cell_id;
+  }
+  division_detected |= entities.divisions_[id + row_policy.north_shift] == cell_id;
+  division_detected |= entities.divisions_[id + row_policy.south_shift] == cell_id;
+
+  return division_detected;
+}
+
 data::FourNeighborIDs get_bacterium_neighbors(
     Entities::EntityID id, const Entities &entities,
     const data::GetNeighborsParameters &parameters);
@@ -27,9 +130,27 @@ bool check_for_empty_neighbors(
     Entities::EntityID id, const Entities &entities,
     const data::GetNeighborsParameters &parameters);
 int sample_random_id(int num_neighbors, std::mt19937 &random_engine);
+int sample_random_id(int num_neighbors, double random_number);
+int collect_empty_neighbors(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters,
+    data::FourNeighborIDs &empty_neighbor_ids);
 Entities::EntityID pick_bacterium_neighbor(
     Entities::EntityID id, const Entities &entities,
     const data::GetNeighborsParameters &parameters, std::mt19937 &random_engine);
+Entities::EntityID pick_bacterium_neighbor(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters, double random_number);
+uint64_t get_neighbor_word(
+    const Entities &entities, const component::Bitboard &cells, int row, int word);
+int get_empty_neighbor_mask(Entities::EntityID id, const Entities &entities);
+Entities::EntityID pick_empty_neighbor(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters, int mask,
+    std::mt19937 &random_engine);
+Entities::EntityID pick_empty_neighbor(
+    Entities::EntityID id, const Entities &entities,
+    const data::GetNeighborsParameters &parameters, int mask, double random_number);
 }   // namespace neighbors
 
 #endif   // BIOFILM_SIMULATION_INDEXER_SYSTEM_HPP
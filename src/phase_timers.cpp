@@ -0,0 +1,50 @@
+#include <phase_timers.hpp>
+
+#include <iostream>
+
+namespace utilities {
+/// Set every phase time to zero.
+PhaseTimers::PhaseTimers() : last_lap_(std::chrono::high_resolution_clock::now()) {
+  for (int phase = 0; phase < kNumberPhases; phase++) {
+    seconds_[phase] = 0.0;
+  }
+}
+
+/// Name of a phase, used for the benchmark summary columns.
+///
+/// @param [in] phase Phase index.
+/// @return Name of the phase.
+std::string PhaseTimers::phase_name(int phase) {
+  switch (phase) {
+    case kPhaseCopy:
+      return "copy";
+    case kPhasePadding:
+      return "padding";
+    case kPhaseDiffusion:
+      return "diffusion";
+    case kPhaseGrowth:
+      return "growth";
+    case kPhaseConsumption:
+      return "consumption";
+    case kPhaseFused:
+      return "fused";
+    case kPhaseHistory:
+      return "history";
+    case kPhaseSteadyState:
+      return "steady_state";
+    default:
+      return "unknown";
+  }
+}
+
+/// Print the time spent in each phase to stdout, if the phase timers are
+/// compiled in.
+void PhaseTimers::print() const {
+#ifdef BIOFILM_PHASE_TIMERS
+  for (int phase = 0; phase < kNumberPhases; phase++) {
+    std::cout << phase_name(phase) << " time = " << seconds_[phase] << " seconds"
+              << "\n";
+  }
+#endif
+}
+}   // namespace utilities
@@ -0,0 +1,59 @@
+#ifndef BIOFILM_SIMULATION_PHASE_TIMERS_HPP
+#define BIOFILM_SIMULATION_PHASE_TIMERS_HPP
+
+#include <chrono>
+#include <string>
+
+#include <omp.h>
+
+namespace utilities {
+enum {
+  kPhaseCopy = 0,
+  kPhasePadding = 1,
+  kPhaseDiffusion = 2,
+  kPhaseGrowth = 3,
+  kPhaseConsumption = 4,
+  kPhaseFused = 5,
+  kPhaseHistory = 6,
+  kPhaseSteadyState = 7,
+  kNumberPhases = 8,
+};
+
+/// Accumulates the time spent in each phase of a time step.
+///
+/// Every call to lap adds the time since the previous lap (or start) to one
+/// phase, so timing a step costs one clock read per phase. In openmp mode only
+/// thread 0 takes laps, right after the implicit barrier that ends each phase.
+/// Configuring with BIOFILM_PHASE_TIMERS=OFF compiles the laps out, and every
+/// phase time then reads as zero.
+struct PhaseTimers {
+  double seconds_[kNumberPhases];  ///< Accumulated time of each phase.
+  std::chrono::time_point<std::chrono::high_resolution_clock> last_lap_;
+
+  PhaseTimers();
+  static std::string phase_name(int phase);
+  void print() const;
+
+#ifdef BIOFILM_PHASE_TIMERS
+  /// Start timing the first phase.
+  void start() { last_lap_ = std::chrono::high_resolution_clock::now(); }
+
+  /// Add the time since the previous lap to a phase.
+  ///
+  /// @param [in] phase Phase that just finished.
+  void lap(int phase) {
+    if (omp_get_thread_num() != 0) {
+      return;
+    }
+    auto now = std::chrono::high_resolution_clock::now();
+    seconds_[phase] += std::chrono::duration<double>(now - last_lap_).count();
+    last_lap_ = now;
+  }
+#else
+  void start() {}
+  void lap(int) {}
+#endif
+};
+}   // namespace utilities
+
+#endif   // BIOFILM_SIMULATION_PHASE_TIMERS_HPP
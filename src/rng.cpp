@@ -0,0 +1,64 @@
+#include <rng.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace rng {
+/// Philox4x32-10 block function.
+///
+/// Implements the counter-based generator from Salmon et al., "Parallel random
+/// numbers: as easy as 1, 2, 3" (SC11). Each call scrambles a 128-bit counter
+/// under a 64-bit key using ten rounds of multiply-xor mixing, so the output
+/// depends only on the counter and key and not on any hidden engine state.
+///
+/// @param [in] counter 128-bit counter block.
+/// @param [in] key 64-bit key block.
+/// @return Four pseudo-random 32-bit words.
+PhiloxCounter philox4x32(PhiloxCounter counter, PhiloxKey key) {
+  const uint64_t kMultiplier0 = 0xD2511F53u;
+  const uint64_t kMultiplier1 = 0xCD9E8D57u;
+  const uint32_t kWeyl0 = 0x9E3779B9u;
+  const uint32_t kWeyl1 = 0xBB67AE85u;
+
+  for (int round = 0; round < 10; round++) {
+    uint64_t product0 = kMultiplier0 * counter[0];
+    uint64_t product1 = kMultiplier1 * counter[2];
+
+    PhiloxCounter mixed{};
+    mixed[0] = static_cast<uint32_t>(product1 >> 32u) ^ counter[1] ^ key[0];
+    mixed[1] = static_cast<uint32_t>(product1);
+    mixed[2] = static_cast<uint32_t>(product0 >> 32u) ^ counter[3] ^ key[1];
+    mixed[3] = static_cast<uint32_t>(product0);
+    counter = mixed;
+
+    key[0] += kWeyl0;
+    key[1] += kWeyl1;
+  }
+
+  return counter;
+}
+
+/// CounterRNG function object constructor.
+///
+/// @param [in] seed Random number generator seed.
+CounterRNG::CounterRNG(uint32_t seed) : kseed_(seed) {}
+
+/// Draw a uniform random number in the range [0.0, 1.0).
+///
+/// The number is a pure function of (seed, step, cell id, draw index), so a
+/// cell draws the same numbers no matter which thread or process visits it, or
+/// in what order the cells are visited.
+///
+/// @param [in] step Time step the number is drawn for.
+/// @param [in] cell_id Cell id in the regular, unpadded grid.
+/// @param [in] draw Draw index distinguishing numbers used by the same cell
+///   during the same time step.
+/// @return Uniform random number in the range [0.0, 1.0).
+double CounterRNG::operator()(uint32_t step, uint32_t cell_id, uint32_t draw) const {
+  PhiloxCounter block =
+      philox4x32(PhiloxCounter{cell_id, step, draw, 0u}, PhiloxKey{kseed_, 0u});
+  uint64_t bits = (static_cast<uint64_t>(block[0]) << 32u) | block[1];
+
+  return static_cast<double>(bits >> 11u) * (1.0 / 9007199254740992.0);
+}
+}   // namespace rng
@@ -0,0 +1,30 @@
+#ifndef BIOFILM_SIMULATION_RNG_HPP
+#define BIOFILM_SIMULATION_RNG_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace rng {
+/// Aliases for the Philox4x32 counter and key blocks
+using PhiloxCounter = std::array<uint32_t, 4>;
+using PhiloxKey = std::array<uint32_t, 2>;
+
+/// Draw indices that distinguish the random numbers used by one cell during one
+/// time step.
+enum : uint32_t {
+  kDrawInitialize = 0,     ///< Draw used to initialize bacterium in first column.
+  kDrawDivide = 1,         ///< Draw used to decide if bacterium divides.
+  kDrawPickNeighbor = 2,   ///< Draw used to pick the neighbor a bacterium divides into.
+};
+
+PhiloxCounter philox4x32(PhiloxCounter counter, PhiloxKey key);
+
+struct CounterRNG {
+  const uint32_t kseed_;
+
+  explicit CounterRNG(uint32_t seed);
+  double operator()(uint32_t step, uint32_t cell_id, uint32_t draw) const;
+};
+}   // namespace rng
+
+#endif   // BIOFILM_SIMULATION_RNG_HPP
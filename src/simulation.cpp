@@ -4,27 +4,157 @@
 #include <iostream>
 #include <memory>
 #include <random>
+#include <vector>
 
+#include <mpi.h>
+#include <omp.h>
+
+#include <checkpoint.hpp>
 #include <cli.hpp>
 #include <consumption_system.hpp>
 #include <copy_system.hpp>
 #include <data.hpp>
 #include <diffusion_system.hpp>
+#include <ensemble_entities.hpp>
+#include <ensemble_system.hpp>
 #include <entities.hpp>
+#include <fused_system.hpp>
 #include <growth_system.hpp>
+#include <history_writer.hpp>
 #include <initializers.hpp>
 #include <neighbors.hpp>
+#include <rng.hpp>
+#include <steady_state_system.hpp>
+#include <step_engines.hpp>
 #include <utilities.hpp>
 
+/// Compute the parameters for creating and initializing the entities of the
+/// full grid. The metadata components are only needed by the debugging
+/// helpers.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] size_padding Thickness of the padding region (ghost cells).
+/// @return Input parameters for creating and initializing simulation entities.
+static data::InitializationParameters
+get_initialization_parameters(const cli_parameters_t &cli_parameters, int size_padding) {
+  return data::InitializationParameters{
+      data::Dimensions{cli_parameters.grid_dimensions[0],
+                       cli_parameters.grid_dimensions[1], size_padding},
+      cli_parameters.probability_bacteria, cli_parameters.max_nutrient, false};
+}
+
+/// Compute the parameters for finding and picking neighbors on the full grid,
+/// with the north and south boundaries wrapping around.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] size_padding Thickness of the padding region (ghost cells).
+/// @return Input parameters needed for finding and picking neighbors.
+static data::GetNeighborsParameters
+get_grid_neighbors_parameters(const cli_parameters_t &cli_parameters, int size_padding) {
+  int cells_per_row = cli_parameters.grid_dimensions[1] + 2 * size_padding;
+
+  data::GetNeighborsParameters get_neighbors_parameters{};
+  get_neighbors_parameters.cells_per_row = cells_per_row;
+  get_neighbors_parameters.first_unpadded_row = size_padding;
+  get_neighbors_parameters.last_unpadded_row =
+      size_padding + cli_parameters.grid_dimensions[0] - 1;
+  get_neighbors_parameters.wraparound_shift =
+      (cli_parameters.grid_dimensions[0] - 1) * cells_per_row;
+  get_neighbors_parameters.first_unpadded_column = size_padding;
+  get_neighbors_parameters.last_unpadded_column =
+      size_padding + cli_parameters.grid_dimensions[1] - 1;
+
+  return get_neighbors_parameters;
+}
+
+/// Initialize the entities in place, drawing the initial bacteria from the
+/// generator selected by rng_mode.
+///
+/// @param [in,out] entities Entities struct to initialize.
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] parameters Input parameters for creating and initializing
+///   simulation entities.
+/// @param [in] indexer Converts 1D cell/entity id to row/column indices.
+/// @param [in] cell_id_converter Converts entity ids to cell ids.
+/// @param [in,out] random_engine Mersenne Twister engine (rng_mode mt).
+/// @param [in] counter_rng Counter-based generator (rng_mode philox).
+static void seed_entities(
+    Entities &entities, const cli_parameters_t &cli_parameters,
+    const data::InitializationParameters &parameters,
+    utilities::IndexConverter &indexer,
+    const utilities::CellIdConverter &cell_id_converter, std::mt19937 &random_engine,
+    const rng::CounterRNG &counter_rng) {
+  if (cli_parameters.rng_mode == "philox") {
+    initializers::initialize_entities(
+        entities, parameters, indexer, cell_id_converter,
+        initializers::BacteriumRandomInitializer(
+            counter_rng, parameters.probability_bacterium));
+  } else {
+    initializers::initialize_entities(
+        entities, parameters, indexer, cell_id_converter,
+        initializers::BacteriumRandomInitializer(
+            random_engine, parameters.probability_bacterium));
+  }
+}
+
 namespace serial {
 /// Run serial version of biofilm simulation
 ///
 /// @param [in] cli_parameters Simulation parameters passed via the command-line
 ///   interface.
 void run_simulation(cli_parameters_t &cli_parameters) {
+  Entities entities;
+  data::SimulationResults results = simulate(cli_parameters, entities);
+  if (!results.completed) {
+    return;
+  }
+
+  // Print benchmark timer results to stdout.
+  std::cout << "simulation time = " << results.simulation_time << " seconds"
+            << "\n"
+            << "history stall time = " << results.history_stall_time << " seconds"
+            << "\n";
+  if (results.converged_step >= 0) {
+    std::cout << "converged step = " << results.converged_step << "\n";
+  }
+  results.phase_timers.print();
+
+  //
+  // Save benchmark results to disk (if summary_filename is set)
+  //
+  utilities::save_benchmark_to_csv(
+      cli_parameters, results.simulation_time, results.history_stall_time,
+      results.converged_step, results.phase_timers, "serial", 1, 1);
+}
+
+/// Simulate the biofilm serially on entities owned by the caller.
+///
+/// The entities are initialized in place, so a caller that runs many
+/// simulations on grids of the same size reuses their memory from one run to
+/// the next. Nothing is printed or saved to the benchmark summary, the
+/// timings are returned instead.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in,out] entities Entities struct the simulation runs on.
+/// @return Timings of the simulation.
+data::SimulationResults
+simulate(const cli_parameters_t &cli_parameters, Entities &entities) {
+  data::SimulationResults results{};
+  results.converged_step = -1;
   // Initialize Mersenne Twister random engine
   std::mt19937 random_engine = std::mt19937(cli_parameters.seed);
 
+  // Initialize counter-based random number generator
+  rng::CounterRNG counter_rng = rng::CounterRNG(cli_parameters.seed);
+
+  // Stop early once the grid stops changing
+  bool use_steady_state = cli_parameters.steady_tolerance > 0.0;
+  data::StepChange step_change{};
+
   // Padding region (ghost cells) thickness fixed to width of one cell
   int size_padding = 1;
 
@@ -32,90 +162,534 @@ void run_simulation(cli_parameters_t &cli_parameters) {
   // Use command-line parameters to compute other simulation parameters
   //
   int cells_per_row = cli_parameters.grid_dimensions[1] + 2 * size_padding;
-
-  // Input parameters for creating and initializing simulation entities.
-  data::InitializationParameters parameters{
-      data::Dimensions{cli_parameters.grid_dimensions[0],
-                       cli_parameters.grid_dimensions[1], size_padding},
-      cli_parameters.probability_bacteria, cli_parameters.max_nutrient};
-
-  // Input parameters needed for finding and picking neighbors.
-  data::GetNeighborsParameters get_neighbors_parameters{};
-  get_neighbors_parameters.cells_per_row = cells_per_row;
-  get_neighbors_parameters.first_unpadded_row = size_padding;
-  get_neighbors_parameters.last_unpadded_row =
-      size_padding + cli_parameters.grid_dimensions[0] - 1;
-  get_neighbors_parameters.wraparound_shift =
-      (cli_parameters.grid_dimensions[0] - 1) * cells_per_row;
+  data::InitializationParameters parameters =
+      get_initialization_parameters(cli_parameters, size_padding);
+  data::GetNeighborsParameters get_neighbors_parameters =
+      get_grid_neighbors_parameters(cli_parameters, size_padding);
 
   //
   // Indexer converts 1D cell/entity id to row/column indices
   //
   utilities::IndexConverter indexer = utilities::IndexConverter(cells_per_row);
 
+  //
+  // Cell id converter keys the counter-based random numbers
+  //
+  utilities::CellIdConverter cell_id_converter =
+      utilities::CellIdConverter(parameters.dimensions);
+
   //
   // Setup and initialize simulation entities (bacteria and nutrients cells)
   //
-  Entities entities =
-      initializers::initialize_entities(parameters, indexer, random_engine);
+  seed_entities(
+      entities, cli_parameters, parameters, indexer, cell_id_converter, random_engine,
+      counter_rng);
+
+  //
+  // Restore simulation state (if restart_filename is set)
+  //
+  if (!cli_parameters.restart_filename.empty() &&
+      !utilities::restore_checkpoint(
+          cli_parameters.restart_filename, entities, 0, random_engine)) {
+    std::cout << "could not restore checkpoint " << cli_parameters.restart_filename
+              << ", exiting...\n";
+    return results;
+  }
 
-  // Number of entities created
-  int num_entities = entities.names_.size();
+  // Diffusion, growth, and consumption kernels selected on the command line
+  transformers::StepEngines engines(
+      cli_parameters, entities, get_neighbors_parameters, cell_id_converter,
+      random_engine, counter_rng, 1);
 
   //
   // Save initial states to disk (if output_filename is set)
   //
-  std::ofstream history_savefile;
-  utilities::save_history_to_csv(
-      history_savefile, cli_parameters, 0, num_entities, entities);
+  utilities::HistoryWriter history_writer(cli_parameters, true);
+  history_writer.save(cli_parameters.restart_step, entities);
 
   //
   // Start benchmark timer
   //
   auto timer = utilities::read_timer();
+  utilities::PhaseTimers phase_timers;
+  phase_timers.start();
 
   //
   // Simulate a number of time steps
   //
-  for (int step = 0; step < cli_parameters.num_steps; step++) {
+  for (int step = cli_parameters.restart_step; step < cli_parameters.num_steps; step++) {
     //
-    // Store a copy of bacteria and nutrients states from prior step
+    // Swap buffers so the states from prior step become the copies
     //
-    transformers::copy_bacteria_states(entities);
-    transformers::copy_nutrients_states(entities);
+    transformers::swap_states(entities);
+    phase_timers.lap(utilities::kPhaseCopy);
 
     //
     // Refresh states in padded region (enforces boundary conditions)
     //
     transformers::refresh_padded_states(entities, cells_per_row);
+    phase_timers.lap(utilities::kPhasePadding);
+
+    //
+    // Fused phases: diffuse, grow, and consume one tile of rows at a time
+    //
+    if (engines.use_fused_step()) {
+      engines.step_fused(entities, step);
+      phase_timers.lap(utilities::kPhaseFused);
+    } else {
+      //
+      // Diffusion phase: apply diffusion transformation to nutrients states
+      //
+      engines.diffuse(entities, phase_timers);
+      phase_timers.lap(utilities::kPhaseDiffusion);
+
+      //
+      // Growth phase: apply growth transformation to bacteria states
+      //
+      engines.grow(entities, step);
+      phase_timers.lap(utilities::kPhaseGrowth);
+
+      //
+      // Consume phase: apply consumption transformation to bacteria and nutrients
+      // states
+      //
+      engines.consume(entities);
+      phase_timers.lap(utilities::kPhaseConsumption);
+    }
+
+    //
+    // Steady state check: measure the changes made by this step (if
+    // steady_tolerance is set)
+    //
+    if (use_steady_state) {
+      transformers::measure_step_change(
+          entities, get_neighbors_parameters, cli_parameters.steady_tolerance,
+          step_change);
+      if (transformers::check_steady_state(
+              step_change, cli_parameters.steady_tolerance)) {
+        results.converged_step = step + 1;
+      }
+      phase_timers.lap(utilities::kPhaseSteadyState);
+    }
+
+    //
+    // Save current states to disk (if output_filename is set)
+    //
+    history_writer.save(step + 1, entities);
+
+    //
+    // Save checkpoint to disk (if due)
+    //
+    if (utilities::check_checkpoint_due(cli_parameters, step + 1) &&
+        !utilities::save_checkpoint(cli_parameters, step + 1, entities, random_engine)) {
+      std::cout << "could not save checkpoint " << cli_parameters.checkpoint_filename
+                << "\n";
+    }
+    phase_timers.lap(utilities::kPhaseHistory);
+
+    //
+    // Skip the remaining steps once the grid has reached a steady state
+    //
+    if (results.converged_step >= 0) {
+      break;
+    }
+  }
+
+  //
+  // Save the steady state as the final step (if the simulation converged
+  // early and output_filename is set)
+  //
+  if (results.converged_step >= 0 && results.converged_step < cli_parameters.num_steps) {
+    history_writer.save(cli_parameters.num_steps, entities);
+  }
+
+  //
+  // Wait for the queued history snapshots to be saved (if output_filename is
+  // set)
+  //
+  history_writer.close();
+  phase_timers.lap(utilities::kPhaseHistory);
+
+  //
+  // Stop benchmark timer
+  //
+  results.completed = true;
+  results.simulation_time =
+      std::chrono::duration<double, std::micro>(utilities::read_timer() - timer).count() /
+      1e6;
+  results.history_stall_time = history_writer.stall_time();
+  results.phase_timers = phase_timers;
+
+  return results;
+}
+
+/// Simulate several replicas of the biofilm at once, interleaved across the
+/// lanes of an ensemble.
+///
+/// The replicas share the grid dimensions and model parameters of the first
+/// lane and differ in their seeds and history filenames. Each lane is
+/// initialized and draws its random numbers exactly as serial::simulate would
+/// with the scan growth engine and rows diffusion engine, so every replica's
+/// history matches that of a single simulation with its seed. The diffusion,
+/// growth, and step engine options are ignored.
+///
+/// @param [in] lane_parameters Simulation parameters of every replica.
+/// @param [in,out] ensemble EnsembleEntities struct the simulation runs on.
+/// @param [in,out] entities Entities struct each replica is initialized on
+///   before it is copied into its lane.
+/// @return Timings of the simulation, shared by every replica.
+data::SimulationResults simulate_ensemble(
+    const std::vector<cli_parameters_t> &lane_parameters, EnsembleEntities &ensemble,
+    Entities &entities) {
+  data::SimulationResults results{};
+  results.converged_step = -1;
+  const cli_parameters_t &cli_parameters = lane_parameters[0];
+  int lanes = lane_parameters.size();
+
+  // Initialize random number generators of every replica
+  std::vector<std::mt19937> random_engines;
+  std::vector<rng::CounterRNG> counter_rngs;
+  for (const cli_parameters_t &parameters : lane_parameters) {
+    random_engines.push_back(std::mt19937(parameters.seed));
+    counter_rngs.push_back(rng::CounterRNG(parameters.seed));
+  }
+  bool use_counter_rng = cli_parameters.rng_mode == "philox";
+
+  // Padding region (ghost cells) thickness fixed to width of one cell
+  int size_padding = 1;
+
+  //
+  // Use command-line parameters to compute other simulation parameters
+  //
+  int cells_per_row = cli_parameters.grid_dimensions[1] + 2 * size_padding;
+  data::InitializationParameters parameters =
+      get_initialization_parameters(cli_parameters, size_padding);
+  data::GetNeighborsParameters get_neighbors_parameters =
+      get_grid_neighbors_parameters(cli_parameters, size_padding);
+
+  //
+  // Indexer converts 1D cell/entity id to row/column indices
+  //
+  utilities::IndexConverter indexer = utilities::IndexConverter(cells_per_row);
+
+  //
+  // Cell id converter keys the counter-based random numbers
+  //
+  utilities::CellIdConverter cell_id_converter =
+      utilities::CellIdConverter(parameters.dimensions);
+
+  //
+  // Setup and initialize every replica, then interleave them into the lanes
+  //
+  initializers::initialize_ensemble_entities(ensemble, parameters.dimensions, lanes);
+  for (int lane = 0; lane < lanes; lane++) {
+    seed_entities(
+        entities, cli_parameters, parameters, indexer, cell_id_converter,
+        random_engines[lane], counter_rngs[lane]);
+    initializers::initialize_ensemble_lane(ensemble, lane, entities);
+  }
+
+  //
+  // Save initial states to disk (if output_filename is set)
+  //
+  std::vector<std::unique_ptr<utilities::HistoryWriter>> history_writers;
+  component::Bacteria lane_bacteria;
+  component::Nutrients lane_nutrients;
+  bool save_history = !cli_parameters.output_filename.empty();
+  for (int lane = 0; lane < lanes; lane++) {
+    history_writers.push_back(std::unique_ptr<utilities::HistoryWriter>(
+        new utilities::HistoryWriter(lane_parameters[lane], save_history)));
+    if (save_history) {
+      utilities::copy_unpadded_ensemble_lane(
+          ensemble, lane, lane_bacteria, lane_nutrients);
+      history_writers[lane]->save(
+          cli_parameters.restart_step, lane_bacteria, lane_nutrients);
+    }
+  }
+
+  //
+  // Start benchmark timer
+  //
+  auto timer = utilities::read_timer();
+  utilities::PhaseTimers phase_timers;
+  phase_timers.start();
+
+  //
+  // Simulate a number of time steps
+  //
+  for (int step = cli_parameters.restart_step; step < cli_parameters.num_steps; step++) {
+    //
+    // Swap buffers so the states from prior step become the copies
+    //
+    transformers::swap_ensemble_states(ensemble);
+    phase_timers.lap(utilities::kPhaseCopy);
+
+    //
+    // Refresh states in padded region (enforces boundary conditions)
+    //
+    transformers::refresh_padded_ensemble_states(ensemble);
+    phase_timers.lap(utilities::kPhasePadding);
 
     //
     // Diffusion phase: apply diffusion transformation to nutrients states
     //
-    transformers::apply_diffusion_transformation(
-        entities, cli_parameters.diffusion_rate, get_neighbors_parameters);
+    for (int substep = 0; substep < cli_parameters.diffusion_substeps; substep++) {
+      // Later substeps diffuse the nutrients from the previous substep
+      if (substep > 0) {
+        phase_timers.lap(utilities::kPhaseDiffusion);
+        transformers::swap_ensemble_nutrients(ensemble);
+        phase_timers.lap(utilities::kPhaseCopy);
+        transformers::refresh_padded_ensemble_nutrients(ensemble);
+        phase_timers.lap(utilities::kPhasePadding);
+      }
+
+      transformers::apply_ensemble_diffusion_transformation(
+          ensemble, cli_parameters.diffusion_rate);
+    }
+    phase_timers.lap(utilities::kPhaseDiffusion);
 
     //
     // Growth phase: apply growth transformation to bacteria states
     //
-    transformers::apply_growth_transformation(
-        entities, cli_parameters.probability_divide, get_neighbors_parameters,
-        random_engine);
+    if (use_counter_rng) {
+      transformers::apply_ensemble_growth_transformation(
+          ensemble, cli_parameters.probability_divide, get_neighbors_parameters,
+          counter_rngs, cell_id_converter, step + 1);
+    } else {
+      transformers::apply_ensemble_growth_transformation(
+          ensemble, cli_parameters.probability_divide, get_neighbors_parameters,
+          random_engines);
+    }
+    phase_timers.lap(utilities::kPhaseGrowth);
 
     //
     // Consume phase: apply consumption transformation to bacteria and nutrients
     // states
     //
-    transformers::apply_consumption_transformation(
-        entities, cli_parameters.consume_amount);
+    transformers::apply_ensemble_consumption_transformation(
+        ensemble, cli_parameters.consume_amount);
+    phase_timers.lap(utilities::kPhaseConsumption);
 
     //
     // Save current states to disk (if output_filename is set)
     //
-    utilities::save_history_to_csv(
-        history_savefile, cli_parameters, step + 1, num_entities, entities);
+    if (save_history) {
+      for (int lane = 0; lane < lanes; lane++) {
+        utilities::copy_unpadded_ensemble_lane(
+            ensemble, lane, lane_bacteria, lane_nutrients);
+        history_writers[lane]->save(step + 1, lane_bacteria, lane_nutrients);
+      }
+    }
+    phase_timers.lap(utilities::kPhaseHistory);
   }
 
+  //
+  // Wait for the queued history snapshots to be saved (if output_filename is
+  // set)
+  //
+  for (int lane = 0; lane < lanes; lane++) {
+    history_writers[lane]->close();
+    results.history_stall_time += history_writers[lane]->stall_time();
+  }
+  phase_timers.lap(utilities::kPhaseHistory);
+
+  //
+  // Stop benchmark timer
+  //
+  results.completed = true;
+  results.simulation_time =
+      std::chrono::duration<double, std::micro>(utilities::read_timer() - timer).count() /
+      1e6;
+  results.phase_timers = phase_timers;
+
+  return results;
+}
+}   // namespace serial
+
+namespace openmp {
+/// Run OpenMP version of biofilm simulation
+///
+/// A single parallel region spans the whole time-step loop. The transformers
+/// contain orphaned "omp for" worksharing loops, so when they are called from
+/// inside this region the iterations are split across the team, and when they
+/// are called by serial::run_simulation they run on one thread as usual. With
+/// counter-based random numbers the growth phase is shared across threads too,
+/// otherwise its proposals are drawn from one Mersenne Twister stream in visit
+/// order by a single thread and only the resolve pass is shared.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+void run_simulation(cli_parameters_t &cli_parameters) {
+  // Initialize Mersenne Twister random engine
+  std::mt19937 random_engine = std::mt19937(cli_parameters.seed);
+
+  // Initialize counter-based random number generator
+  rng::CounterRNG counter_rng = rng::CounterRNG(cli_parameters.seed);
+
+  // Stop early once the grid stops changing
+  bool use_steady_state = cli_parameters.steady_tolerance > 0.0;
+  data::StepChange step_change{};
+  int converged_step = -1;
+
+  // Padding region (ghost cells) thickness fixed to width of one cell
+  int size_padding = 1;
+
+  //
+  // Use command-line parameters to compute other simulation parameters
+  //
+  int cells_per_row = cli_parameters.grid_dimensions[1] + 2 * size_padding;
+  data::InitializationParameters parameters =
+      get_initialization_parameters(cli_parameters, size_padding);
+  data::GetNeighborsParameters get_neighbors_parameters =
+      get_grid_neighbors_parameters(cli_parameters, size_padding);
+
+  //
+  // Indexer converts 1D cell/entity id to row/column indices
+  //
+  utilities::IndexConverter indexer = utilities::IndexConverter(cells_per_row);
+
+  //
+  // Cell id converter keys the counter-based random numbers
+  //
+  utilities::CellIdConverter cell_id_converter =
+      utilities::CellIdConverter(parameters.dimensions);
+
+  //
+  // Setup and initialize simulation entities (bacteria and nutrients cells)
+  //
+  Entities entities;
+  seed_entities(
+      entities, cli_parameters, parameters, indexer, cell_id_converter, random_engine,
+      counter_rng);
+
+  //
+  // Restore simulation state (if restart_filename is set)
+  //
+  if (!cli_parameters.restart_filename.empty() &&
+      !utilities::restore_checkpoint(
+          cli_parameters.restart_filename, entities, 0, random_engine)) {
+    std::cout << "could not restore checkpoint " << cli_parameters.restart_filename
+              << ", exiting...\n";
+    return;
+  }
+
+  // Number of threads in the parallel region
+  int num_threads = omp_get_max_threads();
+
+  // Diffusion, growth, and consumption kernels selected on the command line
+  transformers::StepEngines engines(
+      cli_parameters, entities, get_neighbors_parameters, cell_id_converter,
+      random_engine, counter_rng, num_threads);
+
+  //
+  // Save initial states to disk (if output_filename is set)
+  //
+  utilities::HistoryWriter history_writer(cli_parameters, true);
+  history_writer.save(cli_parameters.restart_step, entities);
+
+  //
+  // Start benchmark timer
+  //
+  auto timer = utilities::read_timer();
+  utilities::PhaseTimers phase_timers;
+  phase_timers.start();
+
+#pragma omp parallel default(shared)
+  {
+    //
+    // Simulate a number of time steps
+    //
+    for (int step = cli_parameters.restart_step; step < cli_parameters.num_steps;
+         step++) {
+      //
+      // Swap buffers so the states from prior step become the copies
+      //
+      transformers::swap_states(entities);
+      phase_timers.lap(utilities::kPhaseCopy);
+
+      //
+      // Refresh states in padded region (enforces boundary conditions)
+      //
+      transformers::refresh_padded_states(entities, cells_per_row);
+      phase_timers.lap(utilities::kPhasePadding);
+
+      //
+      // Diffusion phase: apply diffusion transformation to nutrients states
+      //
+      engines.diffuse(entities, phase_timers);
+      phase_timers.lap(utilities::kPhaseDiffusion);
+
+      //
+      // Growth phase: apply growth transformation to bacteria states
+      //
+      engines.grow(entities, step);
+      phase_timers.lap(utilities::kPhaseGrowth);
+
+      //
+      // Consume phase: apply consumption transformation to bacteria and
+      // nutrients states
+      //
+      engines.consume(entities);
+      phase_timers.lap(utilities::kPhaseConsumption);
+
+      //
+      // Steady state check: measure the changes made by this step (if
+      // steady_tolerance is set), every thread reaches the same verdict
+      //
+      bool converged = false;
+      if (use_steady_state) {
+        transformers::measure_step_change(
+            entities, get_neighbors_parameters, cli_parameters.steady_tolerance,
+            step_change);
+        converged = transformers::check_steady_state(
+            step_change, cli_parameters.steady_tolerance);
+        phase_timers.lap(utilities::kPhaseSteadyState);
+      }
+
+      //
+      // Save current states to disk (if output_filename is set)
+      //
+#pragma omp single
+      history_writer.save(step + 1, entities);
+
+      //
+      // Save checkpoint to disk (if due)
+      //
+#pragma omp single
+      if (utilities::check_checkpoint_due(cli_parameters, step + 1) &&
+          !utilities::save_checkpoint(
+              cli_parameters, step + 1, entities, random_engine)) {
+        std::cout << "could not save checkpoint " << cli_parameters.checkpoint_filename
+                  << "\n";
+      }
+      phase_timers.lap(utilities::kPhaseHistory);
+
+      //
+      // Skip the remaining steps once the grid has reached a steady state
+      //
+      if (converged) {
+#pragma omp single
+        converged_step = step + 1;
+        break;
+      }
+    }
+  }
+
+  //
+  // Save the steady state as the final step (if the simulation converged
+  // early and output_filename is set)
+  //
+  if (converged_step >= 0 && converged_step < cli_parameters.num_steps) {
+    history_writer.save(cli_parameters.num_steps, entities);
+  }
+
+  //
+  // Wait for the queued history snapshots to be saved (if output_filename is
+  // set)
+  //
+  history_writer.close();
+  phase_timers.lap(utilities::kPhaseHistory);
+
   //
   // Stop benchmark timer
   //
@@ -125,11 +699,363 @@ void run_simulation(cli_parameters_t &cli_parameters) {
 
   // Print benchmark timer results to stdout.
   std::cout << "simulation time = " << simulation_time << " seconds"
+            << "\n"
+            << "history stall time = " << history_writer.stall_time() << " seconds"
             << "\n";
+  if (converged_step >= 0) {
+    std::cout << "converged step = " << converged_step << "\n";
+  }
+  phase_timers.print();
 
   //
   // Save benchmark results to disk (if summary_filename is set)
   //
-  utilities::save_benchmark_to_csv(cli_parameters, simulation_time, "serial");
+  utilities::save_benchmark_to_csv(
+      cli_parameters, simulation_time, history_writer.stall_time(), converged_step,
+      phase_timers, "openmp", num_threads, 1);
 }
-}   // namespace serial
+}   // namespace openmp
+
+namespace mpi {
+/// Run MPI version of biofilm simulation
+///
+/// The unpadded grid is split into slabs of consecutive rows, one slab per
+/// process, and every process stores its slab in its own Entities struct. The
+/// padded rows above and below a slab are filled by a halo exchange with the
+/// neighboring processes instead of refresh_padded_states, with the first and
+/// last process connected to keep the north and south boundaries periodic.
+/// Random numbers must come from the counter-based generator keyed on the cell
+/// id of the full grid, which makes the results match the serial simulation.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+void run_simulation(cli_parameters_t &cli_parameters) {
+  int rank;
+  int num_processes;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+
+  // Every process must draw from the same seed
+  MPI_Bcast(&cli_parameters.seed, 1, MPI_UINT32_T, 0, MPI_COMM_WORLD);
+
+  // Initialize counter-based random number generator
+  rng::CounterRNG counter_rng = rng::CounterRNG(cli_parameters.seed);
+
+  // The Mersenne Twister engine is never drawn from, but is saved in
+  // checkpoints like in the other modes
+  std::mt19937 random_engine = std::mt19937(cli_parameters.seed);
+
+  // Stop early once the grid stops changing
+  bool use_steady_state = cli_parameters.steady_tolerance > 0.0;
+  data::StepChange step_change{};
+  int converged_step = -1;
+
+  // Padding region (ghost cells) thickness fixed to width of one cell
+  int size_padding = 1;
+
+  //
+  // Use command-line parameters to compute other simulation parameters
+  //
+  int number_rows = cli_parameters.grid_dimensions[0];
+  int number_columns = cli_parameters.grid_dimensions[1];
+  int cells_per_row = number_columns + 2 * size_padding;
+
+  if (number_rows < num_processes) {
+    if (rank == 0) {
+      std::cout << "mpi mode needs at least one row per process, exiting...\n";
+    }
+    return;
+  }
+
+  //
+  // Split rows into slabs, the first (number_rows % num_processes) slabs get
+  // one extra row
+  //
+  std::vector<int> slab_rows(num_processes);
+  std::vector<int> slab_offsets(num_processes);
+  for (int i = 0; i < num_processes; i++) {
+    slab_rows[i] = number_rows / num_processes + (i < number_rows % num_processes);
+    slab_offsets[i] = (i == 0) ? 0 : slab_offsets[i - 1] + slab_rows[i - 1];
+  }
+  int local_rows = slab_rows[rank];
+
+  // Input parameters for creating and initializing simulation entities. The
+  // metadata components are only needed by the debugging helpers.
+  data::InitializationParameters parameters{
+      data::Dimensions{local_rows, number_columns, size_padding},
+      cli_parameters.probability_bacteria, cli_parameters.max_nutrient, false};
+
+  // Input parameters needed for finding and picking neighbors. The padded rows
+  // hold the neighboring slabs' rows after each exchange, so the wraparound
+  // rows are set to the padded rows and no unpadded cell ever wraps around.
+  data::GetNeighborsParameters get_neighbors_parameters{};
+  get_neighbors_parameters.cells_per_row = cells_per_row;
+  get_neighbors_parameters.first_unpadded_row = 0;
+  get_neighbors_parameters.last_unpadded_row = local_rows + 2 * size_padding - 1;
+  get_neighbors_parameters.wraparound_shift = 0;
+  get_neighbors_parameters.first_unpadded_column = size_padding;
+  get_neighbors_parameters.last_unpadded_column =
+      size_padding + cli_parameters.grid_dimensions[1] - 1;
+
+  //
+  // Indexer converts 1D cell/entity id to row/column indices
+  //
+  utilities::IndexConverter indexer = utilities::IndexConverter(cells_per_row);
+
+  //
+  // Cell id converter maps the slab onto the cell ids of the full grid
+  //
+  utilities::CellIdConverter cell_id_converter = utilities::CellIdConverter(
+      data::Dimensions{number_rows, number_columns, size_padding}, slab_offsets[rank]);
+
+  //
+  // Setup and initialize simulation entities (bacteria and nutrients cells)
+  //
+  Entities entities = initializers::initialize_entities(
+      parameters, indexer, counter_rng, cell_id_converter);
+
+  //
+  // Restore this process's slab of the simulation state (if restart_filename
+  // is set)
+  //
+  if (!cli_parameters.restart_filename.empty() &&
+      !utilities::restore_checkpoint(
+          cli_parameters.restart_filename, entities, slab_offsets[rank],
+          random_engine)) {
+    if (rank == 0) {
+      std::cout << "could not restore checkpoint " << cli_parameters.restart_filename
+                << ", exiting...\n";
+    }
+    return;
+  }
+
+  // Diffusion, growth, and consumption kernels selected on the command line
+  transformers::StepEngines engines(
+      cli_parameters, entities, get_neighbors_parameters, cell_id_converter,
+      random_engine, counter_rng, 1);
+
+  //
+  // Buffers for gathering the slabs on the root process before saving
+  //
+  bool save_history = !cli_parameters.output_filename.empty();
+  int num_local_cells = local_rows * number_columns;
+  component::Bacteria local_bacteria(num_local_cells);
+  component::Nutrients local_nutrients(num_local_cells);
+  component::Bacteria bacteria_history;
+  component::Nutrients nutrients_history;
+  std::vector<int> gather_counts(num_processes);
+  std::vector<int> gather_displacements(num_processes);
+  for (int i = 0; i < num_processes; i++) {
+    gather_counts[i] = slab_rows[i] * number_columns;
+    gather_displacements[i] = slab_offsets[i] * number_columns;
+  }
+  if (rank == 0) {
+    bacteria_history.resize(number_rows * number_columns);
+    nutrients_history.resize(number_rows * number_columns);
+  }
+
+  //
+  // Save initial states to disk (if output_filename is set)
+  //
+  utilities::HistoryWriter history_writer(cli_parameters, rank == 0);
+  if (save_history) {
+    gather_history(
+        entities, cells_per_row, local_bacteria, local_nutrients, bacteria_history,
+        nutrients_history, gather_counts, gather_displacements);
+  }
+  history_writer.save(cli_parameters.restart_step, bacteria_history, nutrients_history);
+
+  //
+  // Start benchmark timer
+  //
+  MPI_Barrier(MPI_COMM_WORLD);
+  auto timer = utilities::read_timer();
+  utilities::PhaseTimers phase_timers;
+  phase_timers.start();
+
+  //
+  // Simulate a number of time steps
+  //
+  for (int step = cli_parameters.restart_step; step < cli_parameters.num_steps; step++) {
+    //
+    // Swap buffers so the states from prior step become the copies
+    //
+    transformers::swap_states(entities);
+    phase_timers.lap(utilities::kPhaseCopy);
+
+    //
+    // Exchange states in padded region with neighboring slabs (enforces
+    // boundary conditions)
+    //
+    transformers::exchange_padded_states(entities, cells_per_row, MPI_COMM_WORLD);
+    phase_timers.lap(utilities::kPhasePadding);
+
+    //
+    // Diffusion phase: apply diffusion transformation to nutrients states,
+    // exchanging the padded nutrients with the neighboring slabs between
+    // substeps
+    //
+    engines.diffuse(entities, phase_timers, [&entities, cells_per_row]() {
+      transformers::exchange_padded_nutrients(entities, cells_per_row, MPI_COMM_WORLD);
+    });
+    phase_timers.lap(utilities::kPhaseDiffusion);
+
+    //
+    // Growth phase: propose divisions, share the ones at the slab edges, then
+    // resolve them
+    //
+    engines.grow(entities, step, [&entities, cells_per_row]() {
+      transformers::exchange_padded_divisions(entities, cells_per_row, MPI_COMM_WORLD);
+    });
+    phase_timers.lap(utilities::kPhaseGrowth);
+
+    //
+    // Consume phase: apply consumption transformation to bacteria and nutrients
+    // states
+    //
+    engines.consume(entities);
+    phase_timers.lap(utilities::kPhaseConsumption);
+
+    //
+    // Steady state check: measure the changes made by this step on every slab
+    // (if steady_tolerance is set)
+    //
+    if (use_steady_state) {
+      transformers::measure_step_change(
+          entities, get_neighbors_parameters, cli_parameters.steady_tolerance,
+          step_change);
+      int changes[2] = {step_change.state_changes, step_change.growing_bacteria};
+      MPI_Allreduce(MPI_IN_PLACE, changes, 2, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+      step_change.state_changes = changes[0];
+      step_change.growing_bacteria = changes[1];
+      MPI_Allreduce(
+          MPI_IN_PLACE, &step_change.max_nutrient_change, 1, MPI_DOUBLE, MPI_MAX,
+          MPI_COMM_WORLD);
+      if (transformers::check_steady_state(
+              step_change, cli_parameters.steady_tolerance)) {
+        converged_step = step + 1;
+      }
+      phase_timers.lap(utilities::kPhaseSteadyState);
+    }
+
+    //
+    // Save current states and checkpoint to disk (if output_filename is set or
+    // checkpoint is due)
+    //
+    bool save_checkpoint = utilities::check_checkpoint_due(cli_parameters, step + 1);
+    if (save_history || save_checkpoint) {
+      gather_history(
+          entities, cells_per_row, local_bacteria, local_nutrients, bacteria_history,
+          nutrients_history, gather_counts, gather_displacements);
+    }
+    if (save_history) {
+      history_writer.save(step + 1, bacteria_history, nutrients_history);
+    }
+    if (save_checkpoint && rank == 0 &&
+        !utilities::save_checkpoint(
+            cli_parameters, step + 1, bacteria_history, nutrients_history,
+            random_engine)) {
+      std::cout << "could not save checkpoint " << cli_parameters.checkpoint_filename
+                << "\n";
+    }
+    phase_timers.lap(utilities::kPhaseHistory);
+
+    //
+    // Skip the remaining steps once the grid has reached a steady state
+    //
+    if (converged_step >= 0) {
+      break;
+    }
+  }
+
+  //
+  // Save the steady state as the final step (if the simulation converged
+  // early and output_filename is set)
+  //
+  if (save_history && converged_step >= 0 && converged_step < cli_parameters.num_steps) {
+    gather_history(
+        entities, cells_per_row, local_bacteria, local_nutrients, bacteria_history,
+        nutrients_history, gather_counts, gather_displacements);
+    history_writer.save(cli_parameters.num_steps, bacteria_history, nutrients_history);
+  }
+
+  //
+  // Wait for the queued history snapshots to be saved (if output_filename is
+  // set)
+  //
+  history_writer.close();
+  phase_timers.lap(utilities::kPhaseHistory);
+
+  //
+  // Stop benchmark timer
+  //
+  MPI_Barrier(MPI_COMM_WORLD);
+  auto simulation_time =
+      std::chrono::duration<double, std::micro>(utilities::read_timer() - timer).count() /
+      1e6;
+
+  // Report each phase's time on the slowest process
+  MPI_Reduce(
+      (rank == 0) ? MPI_IN_PLACE : phase_timers.seconds_, phase_timers.seconds_,
+      utilities::kNumberPhases, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    // Print benchmark timer results to stdout.
+    std::cout << "simulation time = " << simulation_time << " seconds"
+              << "\n"
+              << "history stall time = " << history_writer.stall_time() << " seconds"
+              << "\n";
+    if (converged_step >= 0) {
+      std::cout << "converged step = " << converged_step << "\n";
+    }
+    phase_timers.print();
+
+    //
+    // Save benchmark results to disk (if summary_filename is set)
+    //
+    utilities::save_benchmark_to_csv(
+        cli_parameters, simulation_time, history_writer.stall_time(), converged_step,
+        phase_timers, "mpi", 1, num_processes);
+  }
+}
+
+/// Gather the unpadded cells of every slab on the root process.
+///
+/// @param [in] entities Entities struct with components defining this
+///   process's slab of the nutrients and bacteria grids.
+/// @param [in] cells_per_row The number of columns there are per row in the
+///   padded grid.
+/// @param [out] local_bacteria Buffer for this slab's unpadded bacteria states.
+/// @param [out] local_nutrients Buffer for this slab's unpadded nutrients
+///   states.
+/// @param [out] bacteria Bacteria states of the full grid, ordered by cell id
+///   (root process only).
+/// @param [out] nutrients Nutrients states of the full grid, ordered by cell id
+///   (root process only).
+/// @param [in] counts Number of unpadded cells in each slab.
+/// @param [in] displacements Cell id of the first unpadded cell in each slab.
+void gather_history(
+    const Entities &entities, int cells_per_row, component::Bacteria &local_bacteria,
+    component::Nutrients &local_nutrients, component::Bacteria &bacteria,
+    component::Nutrients &nutrients, const std::vector<int> &counts,
+    const std::vector<int> &displacements) {
+  int cell_id = 0;
+  for (int row = entities.first_unpadded_row(); row <= entities.last_unpadded_row();
+       row++) {
+    for (int column = entities.first_unpadded_column();
+         column <= entities.last_unpadded_column(); column++) {
+      int id = row * cells_per_row + column;
+      local_bacteria[cell_id] = entities.bacteria_[id];
+      local_nutrients[cell_id] = entities.nutrients_[id];
+      cell_id++;
+    }
+  }
+
+  MPI_Gatherv(
+      local_bacteria.data(), cell_id, MPI_UINT8_T, bacteria.data(), counts.data(),
+      displacements.data(), MPI_UINT8_T, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(
+      local_nutrients.data(), cell_id, BIOFILM_MPI_NUTRIENT, nutrients.data(),
+      counts.data(), displacements.data(), BIOFILM_MPI_NUTRIENT, 0, MPI_COMM_WORLD);
+}
+}   // namespace mpi
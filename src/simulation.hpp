@@ -1,10 +1,34 @@
 #ifndef BIOFILM_SIMULATION_SIMULATION_HPP
 #define BIOFILM_SIMULATION_SIMULATION_HPP
 
+#include <vector>
+
 #include <cli.hpp>
+#include <components.hpp>
+#include <data.hpp>
+#include <ensemble_entities.hpp>
+#include <entities.hpp>
 
 namespace serial {
 void run_simulation(cli_parameters_t &cli_parameters);
+data::SimulationResults
+simulate(const cli_parameters_t &cli_parameters, Entities &entities);
+data::SimulationResults simulate_ensemble(
+    const std::vector<cli_parameters_t> &lane_parameters, EnsembleEntities &ensemble,
+    Entities &entities);
+}
+
+namespace openmp {
+void run_simulation(cli_parameters_t &cli_parameters);
+}
+
+namespace mpi {
+void run_simulation(cli_parameters_t &cli_parameters);
+void gather_history(
+    const Entities &entities, int cells_per_row, component::Bacteria &local_bacteria,
+    component::Nutrients &local_nutrients, component::Bacteria &bacteria,
+    component::Nutrients &nutrients, const std::vector<int> &counts,
+    const std::vector<int> &displacements);
 }
 
 #endif   // BIOFILM_SIMULATION_SIMULATION_HPP
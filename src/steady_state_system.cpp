@@ -0,0 +1,110 @@
+#include <steady_state_system.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <entities.hpp>
+#include <neighbors.hpp>
+
+namespace transformers {
+/// Measure how much the last time step changed the grid.
+///
+/// Compares the bacteria and nutrients components with their copies, which
+/// still hold the states from the start of the step. With diffusion substeps,
+/// the nutrients copy holds the states from the start of the last substep
+/// instead. The comparison is one vectorized sweep over the grid. Live
+/// bacteria with an empty neighbor are only counted by a second sweep when no
+/// state changed and no cell's nutrients changed by tolerance or more, since
+/// the step is not steady otherwise. Each thread measures its share of the
+/// rows and the shares are combined into step_change, which must be shared by
+/// the team.
+///
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] get_neighbors_parameters Input data used for finding neighboring
+///   sites.
+/// @param [in] tolerance Largest change of a cell's nutrients that counts as
+///   converged.
+/// @param [out] step_change Changes made by the last time step.
+void measure_step_change(
+    const Entities &entities,
+    const data::GetNeighborsParameters &get_neighbors_parameters, double tolerance,
+    data::StepChange &step_change) {
+  int cells_per_row = entities.cells_per_row();
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+  int first_column = entities.first_unpadded_column();
+  int last_column = entities.last_unpadded_column();
+
+#pragma omp single
+  step_change = data::StepChange{0, 0, 0.0};
+
+  int state_changes = 0;
+  data::Nutrient max_nutrient_change = 0.0;
+
+#pragma omp for schedule(static) nowait
+  for (int row = first_row; row <= last_row; row++) {
+    const data::BacteriumState *bacteria = &entities.bacteria_[row * cells_per_row];
+    const data::BacteriumState *bacteria_copy =
+        &entities.bacteria_copy_[row * cells_per_row];
+    const data::Nutrient *nutrients = &entities.nutrients_[row * cells_per_row];
+    const data::Nutrient *nutrients_copy =
+        &entities.nutrients_copy_[row * cells_per_row];
+
+#pragma omp simd reduction(+ : state_changes) reduction(max : max_nutrient_change)
+    for (int column = first_column; column <= last_column; column++) {
+      data::Nutrient nutrient_change =
+          std::fabs(nutrients[column] - nutrients_copy[column]);
+      state_changes += (bacteria[column] != bacteria_copy[column]);
+      max_nutrient_change = std::max(max_nutrient_change, nutrient_change);
+    }
+  }
+
+#pragma omp critical
+  {
+    step_change.state_changes += state_changes;
+    step_change.max_nutrient_change = std::max(
+        step_change.max_nutrient_change, static_cast<double>(max_nutrient_change));
+  }
+#pragma omp barrier
+
+  if (step_change.state_changes > 0 || step_change.max_nutrient_change >= tolerance) {
+    return;
+  }
+
+  // Nothing changed, so the bacteria_copy component holds the current states
+  int growing_bacteria = 0;
+
+#pragma omp for schedule(static) nowait
+  for (int row = first_row; row <= last_row; row++) {
+    for (int column = first_column; column <= last_column; column++) {
+      Entities::EntityID id = row * cells_per_row + column;
+      if (entities.bacteria_[id] == Entities::kStateBacterium &&
+          neighbors::check_for_empty_neighbors(id, entities, get_neighbors_parameters)) {
+        growing_bacteria++;
+      }
+    }
+  }
+
+#pragma omp critical
+  step_change.growing_bacteria += growing_bacteria;
+#pragma omp barrier
+}
+
+/// Check whether the grid has reached a steady state.
+///
+/// The grid is steady once a step changes no bacteria state, no live bacterium
+/// can divide into an empty neighbor, and no cell's nutrients change by
+/// tolerance or more. Later steps can then only change the grid through the
+/// nutrient drift the tolerance allows, e.g. a surrounded bacterium slowly
+/// starving.
+///
+/// @param [in] step_change Changes made by the last time step.
+/// @param [in] tolerance Largest change of a cell's nutrients that counts as
+///   converged.
+/// @return Whether the grid has reached a steady state.
+bool check_steady_state(const data::StepChange &step_change, double tolerance) {
+  return step_change.state_changes == 0 && step_change.growing_bacteria == 0 &&
+         step_change.max_nutrient_change < tolerance;
+}
+}   // namespace transformers
@@ -0,0 +1,15 @@
+#ifndef BIOFILM_SIMULATION_STEADY_STATE_SYSTEM_HPP
+#define BIOFILM_SIMULATION_STEADY_STATE_SYSTEM_HPP
+
+#include <data.hpp>
+#include <entities.hpp>
+
+namespace transformers {
+void measure_step_change(
+    const Entities &entities,
+    const data::GetNeighborsParameters &get_neighbors_parameters, double tolerance,
+    data::StepChange &step_change);
+bool check_steady_state(const data::StepChange &step_change, double tolerance);
+}   // namespace transformers
+
+#endif   // BIOFILM_SIMULATION_STEADY_STATE_SYSTEM_HPP
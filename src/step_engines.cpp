@@ -0,0 +1,189 @@
+#include <step_engines.hpp>
+
+#include <consumption_system.hpp>
+#include <diffusion_system.hpp>
+#include <fused_system.hpp>
+#include <growth_system.hpp>
+#include <initializers.hpp>
+
+namespace transformers {
+/// Select the kernels and set up the state they keep between steps.
+///
+/// Only the selected kernels' state is allocated, and none of it for the fused
+/// step, which keeps no state between steps. The entities must already hold
+/// the initial (or restored) grid, since the frontier lists are built from its
+/// live bacteria.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] entities Entities struct with components defining the nutrients
+///   and bacteria grids.
+/// @param [in] get_neighbors_parameters Parameters needed for finding and
+///   picking neighbors.
+/// @param [in] cell_id_converter Converts entity ids to the cell ids keying the
+///   counter-based random numbers.
+/// @param [in,out] random_engine Mersenne Twister engine the proposals are
+///   drawn from, unless rng_mode is philox.
+/// @param [in] counter_rng Counter-based generator the proposals are drawn
+///   from if rng_mode is philox.
+/// @param [in] num_threads Number of threads that call the members at once.
+StepEngines::StepEngines(
+    const cli_parameters_t &cli_parameters, const Entities &entities,
+    const data::GetNeighborsParameters &get_neighbors_parameters,
+    const utilities::CellIdConverter &cell_id_converter, std::mt19937 &random_engine,
+    const rng::CounterRNG &counter_rng, int num_threads)
+    : kcli_parameters_(cli_parameters),
+      kget_neighbors_parameters_(get_neighbors_parameters),
+      kcell_id_converter_(cell_id_converter),
+      random_engine_(random_engine),
+      kcounter_rng_(counter_rng),
+      kcells_per_row_(get_neighbors_parameters.cells_per_row),
+      use_counter_rng_(cli_parameters.rng_mode == "philox"),
+      use_row_diffusion_(cli_parameters.diffusion_engine == "rows"),
+      use_blocked_diffusion_(cli_parameters.diffusion_engine == "blocked"),
+      use_dirty_diffusion_(cli_parameters.diffusion_engine == "dirty"),
+      use_implicit_diffusion_(cli_parameters.diffusion_engine == "implicit"),
+      use_frontier_growth_(cli_parameters.growth_engine == "frontier"),
+      use_bitboard_growth_(cli_parameters.growth_engine == "bitboard"),
+      use_fused_step_(cli_parameters.step_engine == "fused") {
+  if (use_frontier_growth_ && !use_fused_step_) {
+    active_cells_ = initializers::initialize_active_cells(entities);
+  }
+  if (use_dirty_diffusion_) {
+    dirty_tiles_ = initializers::initialize_dirty_tiles(entities);
+  }
+  if (use_implicit_diffusion_) {
+    implicit_diffusion_ = initializers::initialize_implicit_diffusion(
+        entities, cli_parameters.diffusion_rate, num_threads);
+  }
+  if (use_blocked_diffusion_) {
+    blocked_diffusion_ = initializers::initialize_blocked_diffusion(
+        entities, cli_parameters.diffusion_substeps, num_threads);
+  }
+}
+
+/// Consume nutrients by the live bacteria, dying where they run out.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void StepEngines::consume(Entities &entities) {
+  if (use_frontier_growth_) {
+    apply_frontier_consumption_transformation(
+        entities, active_cells_, kcli_parameters_.consume_amount);
+  } else {
+    apply_consumption_transformation(entities, kcli_parameters_.consume_amount);
+  }
+}
+
+/// Diffuse, grow, and consume one tile of rows at a time (serial only).
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] step Index of the time step being simulated.
+void StepEngines::step_fused(Entities &entities, int step) {
+  if (use_counter_rng_) {
+    apply_fused_transformation(
+        entities, kcli_parameters_.diffusion_rate, kcli_parameters_.probability_divide,
+        kcli_parameters_.consume_amount, kget_neighbors_parameters_, kcounter_rng_,
+        kcell_id_converter_, step + 1);
+  } else {
+    apply_fused_transformation(
+        entities, kcli_parameters_.diffusion_rate, kcli_parameters_.probability_divide,
+        kcli_parameters_.consume_amount, kget_neighbors_parameters_, random_engine_,
+        kcell_id_converter_);
+  }
+}
+
+/// Whether the fused tiled sweep replaces the diffuse, grow, and consume
+/// phases.
+bool StepEngines::use_fused_step() const { return use_fused_step_; }
+
+/// Run every diffusion substep with the blocked or dirty tile kernel.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void StepEngines::diffuse_tiles(Entities &entities) {
+  if (use_blocked_diffusion_) {
+    apply_blocked_diffusion_transformation(
+        entities, blocked_diffusion_, kcli_parameters_.diffusion_rate,
+        kcli_parameters_.diffusion_substeps);
+  } else {
+    apply_dirty_tile_diffusion_transformation(
+        entities, dirty_tiles_, kcli_parameters_.diffusion_rate);
+  }
+}
+
+/// Run one diffusion substep with the rows, implicit, or gather kernel.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void StepEngines::diffuse_substep(Entities &entities) {
+  if (use_row_diffusion_) {
+    apply_row_diffusion_transformation(
+        entities, kcli_parameters_.diffusion_rate, kcells_per_row_);
+  } else if (use_implicit_diffusion_) {
+    apply_implicit_diffusion_transformation(entities, implicit_diffusion_);
+  } else {
+    apply_diffusion_transformation(
+        entities, kcli_parameters_.diffusion_rate, kget_neighbors_parameters_);
+  }
+}
+
+/// Propose the divisions of the live bacteria. The Mersenne Twister proposals
+/// are drawn in visit order by a single thread, the counter-based ones are
+/// shared across the team.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+/// @param [in] step Index of the time step being simulated.
+void StepEngines::propose_divisions(Entities &entities, int step) {
+  double probability_divide = kcli_parameters_.probability_divide;
+
+  if (use_frontier_growth_ && use_counter_rng_) {
+    propose_frontier_divisions(
+        entities, active_cells_, probability_divide, kget_neighbors_parameters_,
+        kcounter_rng_, kcell_id_converter_, step + 1);
+  } else if (use_frontier_growth_) {
+#pragma omp single
+    propose_frontier_divisions(
+        entities, active_cells_, probability_divide, kget_neighbors_parameters_,
+        random_engine_, kcell_id_converter_);
+  } else if (use_bitboard_growth_ && use_counter_rng_) {
+    refresh_bitboards(entities);
+    propose_bitboard_divisions(
+        entities, probability_divide, kget_neighbors_parameters_, kcounter_rng_,
+        kcell_id_converter_, step + 1);
+  } else if (use_bitboard_growth_) {
+    refresh_bitboards(entities);
+#pragma omp single
+    propose_bitboard_divisions(
+        entities, probability_divide, kget_neighbors_parameters_, random_engine_,
+        kcell_id_converter_);
+  } else if (use_counter_rng_) {
+    transformers::propose_divisions(
+        entities, probability_divide, kget_neighbors_parameters_, kcounter_rng_,
+        kcell_id_converter_, step + 1);
+  } else {
+#pragma omp single
+    transformers::propose_divisions(
+        entities, probability_divide, kget_neighbors_parameters_, random_engine_,
+        kcell_id_converter_);
+  }
+}
+
+/// Turn the proposed divisions into new bacteria.
+///
+/// @param [in,out] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void StepEngines::resolve_divisions(Entities &entities) {
+  if (use_frontier_growth_) {
+    resolve_frontier_divisions(
+        entities, active_cells_, kget_neighbors_parameters_, kcell_id_converter_);
+  } else if (use_bitboard_growth_) {
+    resolve_bitboard_divisions(entities, kget_neighbors_parameters_, kcell_id_converter_);
+  } else {
+    transformers::resolve_divisions(
+        entities, kget_neighbors_parameters_, kcell_id_converter_);
+  }
+}
+}   // namespace transformers
@@ -0,0 +1,137 @@
+#ifndef BIOFILM_SIMULATION_STEP_ENGINES_HPP
+#define BIOFILM_SIMULATION_STEP_ENGINES_HPP
+
+#include <random>
+
+#include <cli.hpp>
+#include <copy_system.hpp>
+#include <data.hpp>
+#include <entities.hpp>
+#include <rng.hpp>
+#include <utilities.hpp>
+
+namespace transformers {
+/// Runs the diffusion, growth, and consumption kernels selected on the
+/// command line.
+///
+/// The kernels and the state they keep between steps (the frontier lists,
+/// dirty tiles, implicit coefficients, and blocked scratch buffers) are picked
+/// once when the struct is built, so the serial, OpenMP, and MPI time-step
+/// loops share one dispatch and only differ in how they fill the padded
+/// region. The members may be called by every thread of a parallel region:
+/// the kernels share their rows across the team, and the proposals drawn from
+/// the Mersenne Twister engine run on a single thread.
+class StepEngines {
+ public:
+  StepEngines(
+      const cli_parameters_t &cli_parameters, const Entities &entities,
+      const data::GetNeighborsParameters &get_neighbors_parameters,
+      const utilities::CellIdConverter &cell_id_converter,
+      std::mt19937 &random_engine, const rng::CounterRNG &counter_rng,
+      int num_threads);
+
+  /// Diffuse the nutrients through every substep, refreshing the padded
+  /// region between substeps with refresh_padded_nutrients.
+  ///
+  /// @param [in,out] entities Entities struct with components defining the
+  ///   nutrients and bacteria grids.
+  /// @param [in,out] phase_timers Timers the substeps' copies and padding
+  ///   refreshes are counted in.
+  void diffuse(Entities &entities, utilities::PhaseTimers &phase_timers) {
+    int cells_per_row = kcells_per_row_;
+    diffuse(entities, phase_timers, [&entities, cells_per_row]() {
+      refresh_padded_nutrients(entities, cells_per_row);
+    });
+  }
+
+  /// Diffuse the nutrients through every substep.
+  ///
+  /// @param [in,out] entities Entities struct with components defining the
+  ///   nutrients and bacteria grids.
+  /// @param [in,out] phase_timers Timers the substeps' copies and padding
+  ///   refreshes are counted in.
+  /// @param [in] refresh_padding Fills the padded nutrients before every
+  ///   substep after the first.
+  template <typename RefreshPadding>
+  void diffuse(
+      Entities &entities, utilities::PhaseTimers &phase_timers,
+      RefreshPadding refresh_padding) {
+    // The tiled kernels run every substep on their own
+    if (use_blocked_diffusion_ || use_dirty_diffusion_) {
+      diffuse_tiles(entities);
+      return;
+    }
+
+    for (int substep = 0; substep < kcli_parameters_.diffusion_substeps; substep++) {
+      // Later substeps diffuse the nutrients from the previous substep
+      if (substep > 0) {
+        phase_timers.lap(utilities::kPhaseDiffusion);
+        swap_nutrients(entities);
+        phase_timers.lap(utilities::kPhaseCopy);
+        refresh_padding();
+        phase_timers.lap(utilities::kPhasePadding);
+      }
+
+      diffuse_substep(entities);
+    }
+  }
+
+  /// Grow new bacteria through cellular division.
+  ///
+  /// @param [in,out] entities Entities struct with components defining the
+  ///   nutrients and bacteria grids.
+  /// @param [in] step Index of the time step being simulated.
+  void grow(Entities &entities, int step) {
+    grow(entities, step, []() {});
+  }
+
+  /// Grow new bacteria through cellular division.
+  ///
+  /// @param [in,out] entities Entities struct with components defining the
+  ///   nutrients and bacteria grids.
+  /// @param [in] step Index of the time step being simulated.
+  /// @param [in] share_divisions Called between proposing and resolving the
+  ///   divisions, so the proposals in the padded region can be filled in.
+  template <typename ShareDivisions>
+  void grow(Entities &entities, int step, ShareDivisions share_divisions) {
+    propose_divisions(entities, step);
+    share_divisions();
+    resolve_divisions(entities);
+  }
+
+  void consume(Entities &entities);
+  void step_fused(Entities &entities, int step);
+  bool use_fused_step() const;
+
+ private:
+  void diffuse_tiles(Entities &entities);
+  void diffuse_substep(Entities &entities);
+  void propose_divisions(Entities &entities, int step);
+  void resolve_divisions(Entities &entities);
+
+  const cli_parameters_t &kcli_parameters_;
+  const data::GetNeighborsParameters &kget_neighbors_parameters_;
+  const utilities::CellIdConverter &kcell_id_converter_;
+  std::mt19937 &random_engine_;
+  const rng::CounterRNG &kcounter_rng_;
+  const int kcells_per_row_;
+  const bool use_counter_rng_;
+  const bool use_row_diffusion_;
+  const bool use_blocked_diffusion_;
+  const bool use_dirty_diffusion_;
+  const bool use_implicit_diffusion_;
+  const bool use_frontier_growth_;
+  const bool use_bitboard_growth_;
+  const bool use_fused_step_;
+  data::ActiveCells active_cells_;  ///< Live bacteria visited by the frontier
+                                    ///< growth engine.
+  data::DirtyTiles dirty_tiles_;    ///< Tiles of nutrients skipped by the dirty
+                                    ///< diffusion engine once equilibrated.
+  data::ImplicitDiffusion implicit_diffusion_;  ///< Coefficients of the implicit
+                                                ///< diffusion engine.
+  data::BlockedDiffusion blocked_diffusion_;    ///< Scratch buffers of the
+                                                ///< blocked diffusion engine.
+};
+}   // namespace transformers
+
+#endif   // BIOFILM_SIMULATION_STEP_ENGINES_HPP
@@ -0,0 +1,310 @@
+#include <sweep.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <ensemble_entities.hpp>
+#include <entities.hpp>
+#include <simulation.hpp>
+#include <utilities.hpp>
+
+namespace sweep {
+/// Simulation parameters of one job, the command-line parameters with the
+/// job's model parameters and history filename filled in.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] sweep_job Model parameters of the job.
+/// @param [in] job Index of the job in the sweep.
+/// @return Simulation parameters of the job.
+static cli_parameters_t get_job_parameters(
+    const cli_parameters_t &cli_parameters, const data::SweepJob &sweep_job, int job) {
+  cli_parameters_t job_parameters = cli_parameters;
+  job_parameters.seed = sweep_job.seed;
+  job_parameters.probability_divide = sweep_job.probability_divide;
+  job_parameters.diffusion_rate = sweep_job.diffusion_rate;
+  job_parameters.consume_amount = sweep_job.consume_amount;
+  if (!cli_parameters.output_filename.empty()) {
+    job_parameters.output_filename =
+        get_job_output_filename(cli_parameters.output_filename, job);
+  }
+
+  return job_parameters;
+}
+
+/// Split the jobs into ensembles of replicas that run together.
+///
+/// Adjacent jobs with the same model parameters, which differ only in their
+/// seeds, are grouped into ensembles of at most ensemble_lanes jobs.
+///
+/// @param [in] jobs Model parameters of every job in the sweep.
+/// @param [in] ensemble_lanes Largest number of jobs in an ensemble.
+/// @return Index of the first job of every ensemble, followed by the number of
+///   jobs.
+static std::vector<int>
+get_ensemble_starts(const std::vector<data::SweepJob> &jobs, int ensemble_lanes) {
+  std::vector<int> ensemble_starts;
+  int number_jobs = jobs.size();
+
+  for (int job = 0; job < number_jobs; job++) {
+    bool same_parameters =
+        job > 0 && jobs[job].probability_divide == jobs[job - 1].probability_divide &&
+        jobs[job].diffusion_rate == jobs[job - 1].diffusion_rate &&
+        jobs[job].consume_amount == jobs[job - 1].consume_amount;
+    if (ensemble_starts.empty() || !same_parameters ||
+        job - ensemble_starts.back() == ensemble_lanes) {
+      ensemble_starts.push_back(job);
+    }
+  }
+  ensemble_starts.push_back(number_jobs);
+
+  return ensemble_starts;
+}
+
+/// Run ensembles until none are left, one worker thread of the sweep.
+///
+/// Every worker keeps one Entities and one EnsembleEntities struct, so the
+/// grid's memory is allocated by the first job a worker runs and reused by the
+/// rest. An ensemble of one job runs the serial simulation, larger ones run
+/// the ensemble simulation.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @param [in] jobs Model parameters of every job in the sweep.
+/// @param [in] ensemble_starts Index of the first job of every ensemble,
+///   followed by the number of jobs.
+/// @param [out] results Timings of every job in the sweep.
+/// @param [in,out] next_ensemble Index of the next ensemble no worker has
+///   started.
+static void run_jobs(
+    const cli_parameters_t &cli_parameters, const std::vector<data::SweepJob> &jobs,
+    const std::vector<int> &ensemble_starts,
+    std::vector<data::SimulationResults> &results, std::atomic<int> &next_ensemble) {
+  Entities entities;
+  EnsembleEntities ensemble;
+  int number_ensembles = ensemble_starts.size() - 1;
+
+  for (int index = next_ensemble++; index < number_ensembles; index = next_ensemble++) {
+    int first_job = ensemble_starts[index];
+    int end_job = ensemble_starts[index + 1];
+    if (end_job - first_job == 1) {
+      cli_parameters_t job_parameters =
+          get_job_parameters(cli_parameters, jobs[first_job], first_job);
+      results[first_job] = serial::simulate(job_parameters, entities);
+      continue;
+    }
+
+    std::vector<cli_parameters_t> lane_parameters;
+    for (int job = first_job; job < end_job; job++) {
+      lane_parameters.push_back(get_job_parameters(cli_parameters, jobs[job], job));
+    }
+    data::SimulationResults ensemble_results =
+        serial::simulate_ensemble(lane_parameters, ensemble, entities);
+    for (int job = first_job; job < end_job; job++) {
+      results[job] = ensemble_results;
+    }
+  }
+}
+
+/// Run a parameter sweep, many serial simulations on a pool of threads.
+///
+/// The jobs are read from the jobs file, or else span the grid of the sweep
+/// parameter lists. Replicas of a parameter combination are grouped into
+/// ensembles of up to ensemble_lanes jobs, and each ensemble runs on one
+/// thread. The benchmark summary gets one line per job, saved once all jobs are
+/// done, and the jobs of an ensemble share its timings.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+void run_simulation(cli_parameters_t &cli_parameters) {
+  std::vector<data::SweepJob> jobs;
+  if (cli_parameters.sweep_jobs_filename.empty()) {
+    jobs = make_job_grid(cli_parameters);
+  } else if (!read_jobs(
+                 cli_parameters.sweep_jobs_filename,
+                 cli_parameters.diffusion_engine == "implicit" ? 1.0E6 : 0.125, jobs)) {
+    std::cout << "could not read jobs file " << cli_parameters.sweep_jobs_filename
+              << ", exiting...\n";
+    return;
+  }
+
+  if (jobs.empty()) {
+    std::cout << "no jobs to run, exiting...\n";
+    return;
+  }
+
+  std::vector<int> ensemble_starts =
+      get_ensemble_starts(jobs, cli_parameters.ensemble_lanes);
+  int num_ensembles = ensemble_starts.size() - 1;
+  int num_threads = std::min(cli_parameters.sweep_threads, num_ensembles);
+  std::vector<data::SimulationResults> results(jobs.size());
+  std::atomic<int> next_ensemble(0);
+
+  //
+  // Start benchmark timer
+  //
+  auto timer = utilities::read_timer();
+
+  std::vector<std::thread> workers;
+  for (int thread = 0; thread < num_threads; thread++) {
+    workers.push_back(std::thread(
+        run_jobs, std::cref(cli_parameters), std::cref(jobs), std::cref(ensemble_starts),
+        std::ref(results), std::ref(next_ensemble)));
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  //
+  // Stop benchmark timer
+  //
+  auto sweep_time =
+      std::chrono::duration<double, std::micro>(utilities::read_timer() - timer).count() /
+      1e6;
+
+  // Print benchmark timer results to stdout.
+  std::cout << "sweep jobs = " << jobs.size() << "\n"
+            << "sweep ensembles = " << num_ensembles << "\n"
+            << "sweep threads = " << num_threads << "\n"
+            << "sweep time = " << sweep_time << " seconds"
+            << "\n"
+            << "jobs per second = " << jobs.size() / sweep_time << "\n";
+
+  //
+  // Save benchmark results of every job to disk (if summary_filename is set)
+  //
+  if (cli_parameters.summary_filename.empty()) {
+    return;
+  }
+  bool write_header = utilities::check_if_empty(cli_parameters.summary_filename);
+  std::ofstream benchmark_savefile(cli_parameters.summary_filename, std::ios::app);
+  if (!benchmark_savefile) {
+    std::cout << "could not open " << cli_parameters.summary_filename << "\n";
+    return;
+  }
+  if (write_header) {
+    utilities::write_benchmark_header(benchmark_savefile);
+  }
+  for (int index = 0; index < num_ensembles; index++) {
+    int first_job = ensemble_starts[index];
+    int end_job = ensemble_starts[index + 1];
+    for (int job = first_job; job < end_job; job++) {
+      cli_parameters_t job_parameters =
+          get_job_parameters(cli_parameters, jobs[job], job);
+      job_parameters.ensemble_lanes = end_job - first_job;
+      utilities::write_benchmark_row(
+          benchmark_savefile, job_parameters, results[job].simulation_time,
+          results[job].history_stall_time, results[job].converged_step,
+          results[job].phase_timers, "sweep", num_threads, 1);
+    }
+  }
+}
+
+/// List the jobs spanning the grid of the sweep parameter lists.
+///
+/// Every combination of division probability, diffusion rate, and consume
+/// amount is run with sweep_replicas seeds, counting up from the seed. A
+/// parameter without a sweep list keeps its single command-line value.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the command-line
+///   interface.
+/// @return Model parameters of every job, replicas of a combination adjacent.
+std::vector<data::SweepJob> make_job_grid(const cli_parameters_t &cli_parameters) {
+  std::vector<double> probabilities_divide = cli_parameters.sweep_probability_divide;
+  std::vector<double> diffusion_rates = cli_parameters.sweep_diffusion_rate;
+  std::vector<double> consume_amounts = cli_parameters.sweep_consume_amount;
+  if (probabilities_divide.empty()) {
+    probabilities_divide.push_back(cli_parameters.probability_divide);
+  }
+  if (diffusion_rates.empty()) {
+    diffusion_rates.push_back(cli_parameters.diffusion_rate);
+  }
+  if (consume_amounts.empty()) {
+    consume_amounts.push_back(cli_parameters.consume_amount);
+  }
+
+  std::vector<data::SweepJob> jobs;
+  for (double probability_divide : probabilities_divide) {
+    for (double diffusion_rate : diffusion_rates) {
+      for (double consume_amount : consume_amounts) {
+        for (int replica = 0; replica < cli_parameters.sweep_replicas; replica++) {
+          jobs.push_back(data::SweepJob{
+              cli_parameters.seed + replica, probability_divide, diffusion_rate,
+              consume_amount});
+        }
+      }
+    }
+  }
+
+  return jobs;
+}
+
+/// Read the jobs of a sweep from a text file.
+///
+/// Every line lists the seed, division probability, diffusion rate, and
+/// consume amount of one job, separated by spaces or commas. Blank lines and
+/// everything after a # are ignored.
+///
+/// @param [in] filename Path to jobs file.
+/// @param [in] max_diffusion_rate Largest diffusion rate the diffusion engine
+///   is stable at.
+/// @param [out] jobs Model parameters of every job in the file.
+/// @return Whether the file could be read and every job is valid.
+bool read_jobs(
+    const std::string &filename, double max_diffusion_rate,
+    std::vector<data::SweepJob> &jobs) {
+  std::ifstream f(filename);
+  if (!f) {
+    return false;
+  }
+
+  std::string line;
+  int line_number = 0;
+  while (std::getline(f, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    std::replace(line.begin(), line.end(), ',', ' ');
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    std::istringstream fields(line);
+    data::SweepJob job{};
+    std::string rest;
+    if (!(fields >> job.seed >> job.probability_divide >> job.diffusion_rate >>
+          job.consume_amount) ||
+        (fields >> rest) || job.probability_divide < 0.0 ||
+        job.probability_divide > 1.0 || job.diffusion_rate < 0.0 ||
+        job.diffusion_rate > max_diffusion_rate || job.consume_amount < 0.0 ||
+        job.consume_amount > 1.0) {
+      std::cout << filename << ":" << line_number
+                << ": expected seed, prob-divide, diffusion-rate, and consume\n";
+      return false;
+    }
+    jobs.push_back(job);
+  }
+
+  return true;
+}
+
+/// History filename of one job, the job index inserted before the extension.
+///
+/// @param [in] filename History filename passed via the command-line interface.
+/// @param [in] job Index of the job in the sweep.
+/// @return History filename of the job, e.g. history_12.bin for job 12.
+std::string get_job_output_filename(const std::string &filename, int job) {
+  std::string::size_type slash = filename.find_last_of('/');
+  std::string::size_type dot = filename.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    dot = filename.size();
+  }
+
+  return filename.substr(0, dot) + "_" + std::to_string(job) + filename.substr(dot);
+}
+}   // namespace sweep
@@ -0,0 +1,19 @@
+#ifndef BIOFILM_SIMULATION_SWEEP_HPP
+#define BIOFILM_SIMULATION_SWEEP_HPP
+
+#include <string>
+#include <vector>
+
+#include <cli.hpp>
+#include <data.hpp>
+
+namespace sweep {
+void run_simulation(cli_parameters_t &cli_parameters);
+std::vector<data::SweepJob> make_job_grid(const cli_parameters_t &cli_parameters);
+bool read_jobs(
+    const std::string &filename, double max_diffusion_rate,
+    std::vector<data::SweepJob> &jobs);
+std::string get_job_output_filename(const std::string &filename, int job);
+}   // namespace sweep
+
+#endif   // BIOFILM_SIMULATION_SWEEP_HPP
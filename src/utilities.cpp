@@ -1,9 +1,13 @@
 #include <utilities.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <cli.hpp>
 #include <components.hpp>
@@ -72,13 +76,13 @@ int get_cell_location(data::CellLocationParameters &parameters) {
 /// @param [in] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 void print_bacteria_grid(Entities &entities) {
-  int number_entities = entities.names_.size();
+  int number_entities = entities.size();
   int previous_column_index = 0;
 
   for (int id = 0; id < number_entities; id++) {
-    int column_index = entities.indices_[id].column;
-    bool not_pad_cell =
-        (entities.flags_[id] & Entities::kFlagBacteria) == Entities::kFlagBacteria;
+    int column_index = entities.index(id).column;
+    bool not_pad_cell = (entities.active_components(id) & Entities::kFlagBacteria) ==
+                        Entities::kFlagBacteria;
 
     if (not_pad_cell & (column_index > previous_column_index)) {
       std::cout << " ";
@@ -87,7 +91,7 @@ void print_bacteria_grid(Entities &entities) {
     }
 
     if (not_pad_cell) {
-      std::cout << entities.bacteria_[id];
+      std::cout << static_cast<int>(entities.bacteria_[id]);
     }
 
     previous_column_index = column_index;
@@ -104,13 +108,13 @@ void print_bacteria_grid(Entities &entities) {
 /// @param [in] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 void print_nutrients_grid(Entities &entities) {
-  int number_entities = entities.names_.size();
+  int number_entities = entities.size();
   int previous_column_index = 0;
 
   for (int id = 0; id < number_entities; id++) {
-    int column_index = entities.indices_[id].column;
-    bool not_pad_cell =
-        (entities.flags_[id] & Entities::kFlagNutrients) == Entities::kFlagNutrients;
+    int column_index = entities.index(id).column;
+    bool not_pad_cell = (entities.active_components(id) & Entities::kFlagNutrients) ==
+                        Entities::kFlagNutrients;
 
     if (not_pad_cell & (column_index > previous_column_index)) {
       std::cout << " ";
@@ -136,11 +140,11 @@ void print_nutrients_grid(Entities &entities) {
 /// @param [in] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 void print_bacteria_copy_grid(Entities &entities) {
-  int number_entities = entities.names_.size();
+  int number_entities = entities.size();
   int previous_column_index = 0;
 
   for (int id = 0; id < number_entities; id++) {
-    int column_index = entities.indices_[id].column;
+    int column_index = entities.index(id).column;
 
     if (column_index > previous_column_index) {
       std::cout << " ";
@@ -148,7 +152,7 @@ void print_bacteria_copy_grid(Entities &entities) {
       std::cout << "\n";
     }
 
-    std::cout << entities.bacteria_copy_[id];
+    std::cout << static_cast<int>(entities.bacteria_copy_[id]);
     previous_column_index = column_index;
   }
 
@@ -163,11 +167,11 @@ void print_bacteria_copy_grid(Entities &entities) {
 /// @param [in] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 void print_nutrients_copy_grid(Entities &entities) {
-  int number_entities = entities.names_.size();
+  int number_entities = entities.size();
   int previous_column_index = 0;
 
   for (int id = 0; id < number_entities; id++) {
-    int column_index = entities.indices_[id].column;
+    int column_index = entities.index(id).column;
 
     if (column_index > previous_column_index) {
       std::cout << " ";
@@ -185,16 +189,17 @@ void print_nutrients_copy_grid(Entities &entities) {
 /// Print the locations component to stdout as a 2D grid.
 ///
 /// This is a helper function that can be used for debugging purposes. By
-/// default it is not used anywhere in the program.
+/// default it is not used anywhere in the program. The locations component is
+/// metadata, so the entities must be initialized with metadata enabled.
 ///
 /// @param [in] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
 void print_cell_locations(Entities &entities) {
-  int number_entities = entities.names_.size();
+  int number_entities = entities.size();
   int previous_column_index = 0;
 
   for (int id = 0; id < number_entities; id++) {
-    int column_index = entities.indices_[id].column;
+    int column_index = entities.index(id).column;
 
     if (column_index > previous_column_index) {
       std::cout << " ";
@@ -239,6 +244,37 @@ data::Index IndexConverter::operator()(int id) {
   return index;
 }
 
+/// CellIdConverter function object constructor.
+///
+/// @param [in] dimensions Dimensions of the full 2D grid, which can be larger
+///   than the grid stored in Entities when the rows are split across processes.
+/// @param [in] row_offset Row of the full, unpadded grid that the first
+///   unpadded row in Entities maps to.
+CellIdConverter::CellIdConverter(const data::Dimensions &dimensions, int row_offset)
+    : knumber_rows_(dimensions.number_rows), knumber_columns_(dimensions.number_columns),
+      ksize_padding_(dimensions.size_padding), krow_offset_(row_offset) {}
+
+/// Convert a (row, column) paired index on the padded grid into a cell id.
+///
+/// Cell ids count the cells of the full, unpadded grid in row-major order,
+/// matching the cell_id column of the simulation history file. Unlike entity
+/// ids, they do not depend on how the padded grid is stored. Rows past the top
+/// or bottom of the full grid wrap around, so ghost rows map to the cells they
+/// mirror.
+///
+/// @param [in] index Row and column indices of entity in padded grid.
+/// @return Cell id of entity in full, unpadded grid.
+int CellIdConverter::operator()(const data::Index &index) const {
+  int row = index.row - ksize_padding_ + krow_offset_;
+  if (row < 0) {
+    row += knumber_rows_;
+  } else if (row >= knumber_rows_) {
+    row -= knumber_rows_;
+  }
+
+  return (index.column - ksize_padding_) + knumber_columns_ * row;
+}
+
 /// Check if a file is empty or not.
 ///
 /// @param [in] filename Path to file to check.
@@ -263,10 +299,19 @@ bool check_if_empty(std::string filename) {
 /// @param [in] cli_parameters Simulation parameters passed via the
 ///   command-line.
 /// @param [in] simulation_time The simulation running time in seconds.
+/// @param [in] history_stall_time Part of the simulation running time spent
+///   waiting for history snapshots to be saved, in seconds.
+/// @param [in] converged_step Step the simulation stopped at after reaching a
+///   steady state, -1 if it ran every step.
+/// @param [in] phase_timers Time spent in each phase of the time steps, written
+///   with the cells advanced per second of each phase.
 /// @param [in] run_mode Simulation running mode, i.e. serial mode.
+/// @param [in] num_threads Number of threads used to run the simulation.
+/// @param [in] num_processes Number of processes used to run the simulation.
 void save_benchmark_to_csv(
     const cli_parameters_t &cli_parameters, double simulation_time,
-    std::string run_mode) {
+    double history_stall_time, int converged_step, const PhaseTimers &phase_timers,
+    std::string run_mode, int num_threads, int num_processes) {
   std::ofstream benchmark_savefile;
   if (cli_parameters.summary_filename.empty()) {
     benchmark_savefile.open(nullptr);
@@ -276,48 +321,211 @@ void save_benchmark_to_csv(
 
   if (benchmark_savefile) {
     if (check_if_empty(cli_parameters.summary_filename)) {
-      benchmark_savefile << "steps"
-                         << ","
-                         << "num_rows"
-                         << ","
-                         << "num_columns"
-                         << ","
-                         << "sim_time"
-                         << ","
-                         << "run_mode"
-                         << "\r\n";
+      write_benchmark_header(benchmark_savefile);
     }
-    benchmark_savefile << cli_parameters.num_steps << ","
-                       << cli_parameters.grid_dimensions[0] << ","
-                       << cli_parameters.grid_dimensions[1] << "," << simulation_time
-                       << "," << run_mode << "\r\n";
+    write_benchmark_row(
+        benchmark_savefile, cli_parameters, simulation_time, history_stall_time,
+        converged_step, phase_timers, run_mode, num_threads, num_processes);
   }
 }
 
-/// Save simulation history snapshots to csv format if filename is provided.
+/// Write the header line of the benchmark summary.
 ///
-/// If no filename is set via the command-line interface, then no file will be
-/// saved. If a filename is provided, then if the file is empty (or doesn't
-/// exist), it will be created and a header line will be added. The simulation
-/// history snapshots are then accumulated in the file stream buffer to be saved
-/// to disk. The output file can be used for generating animations.
+/// @param [in,out] f Benchmark summary file.
+void write_benchmark_header(std::ostream &f) {
+  f << "steps"
+    << ","
+    << "num_rows"
+    << ","
+    << "num_columns"
+    << ","
+    << "seed"
+    << ","
+    << "prob_divide"
+    << ","
+    << "diffusion_rate"
+    << ","
+    << "consume"
+    << ","
+    << "sim_time"
+    << ","
+    << "run_mode"
+    << ","
+    << "num_threads"
+    << ","
+    << "num_processes"
+    << ","
+    << "ensemble_lanes"
+    << ","
+    << "precision"
+    << ","
+    << "history_stall_time"
+    << ","
+    << "converged_step";
+  for (int phase = 0; phase < kNumberPhases; phase++) {
+    f << "," << PhaseTimers::phase_name(phase) << "_time"
+      << "," << PhaseTimers::phase_name(phase) << "_cells_per_second";
+  }
+  f << "\r\n";
+}
+
+/// Write one simulation's line of the benchmark summary.
 ///
-/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in,out] f Benchmark summary file.
 /// @param [in] cli_parameters Simulation parameters passed via the
 ///   command-line.
-/// @param [in] step The current step number in the simulation.
-/// @param [in] num_entities The total number of entities in the simulation.
+/// @param [in] simulation_time The simulation running time in seconds.
+/// @param [in] history_stall_time Part of the simulation running time spent
+///   waiting for history snapshots to be saved, in seconds.
+/// @param [in] converged_step Step the simulation stopped at after reaching a
+///   steady state, -1 if it ran every step.
+/// @param [in] phase_timers Time spent in each phase of the time steps.
+/// @param [in] run_mode Simulation running mode, i.e. serial mode.
+/// @param [in] num_threads Number of threads used to run the simulation.
+/// @param [in] num_processes Number of processes used to run the simulation.
+void write_benchmark_row(
+    std::ostream &f, const cli_parameters_t &cli_parameters, double simulation_time,
+    double history_stall_time, int converged_step, const PhaseTimers &phase_timers,
+    std::string run_mode, int num_threads, int num_processes) {
+  // Name of the scalar type stored in the nutrients component.
+  std::string nutrient_precision =
+      (sizeof(data::Nutrient) == sizeof(float)) ? "float" : "double";
+
+  // Cells advanced by this run, for the per-phase throughput. The phases of an
+  // ensemble advance every replica at once.
+  int last_step = (converged_step < 0) ? cli_parameters.num_steps : converged_step;
+  double cells_stepped = static_cast<double>(cli_parameters.grid_dimensions[0]) *
+                         cli_parameters.grid_dimensions[1] *
+                         (last_step - cli_parameters.restart_step) *
+                         cli_parameters.ensemble_lanes;
+
+  f << cli_parameters.num_steps << "," << cli_parameters.grid_dimensions[0] << ","
+    << cli_parameters.grid_dimensions[1] << "," << cli_parameters.seed << ","
+    << cli_parameters.probability_divide << "," << cli_parameters.diffusion_rate << ","
+    << cli_parameters.consume_amount << "," << simulation_time << "," << run_mode
+    << "," << num_threads << "," << num_processes << ","
+    << cli_parameters.ensemble_lanes << "," << nutrient_precision << ","
+    << history_stall_time << "," << converged_step;
+  for (int phase = 0; phase < kNumberPhases; phase++) {
+    double phase_time = phase_timers.seconds_[phase];
+    f << "," << phase_time << ","
+      << ((phase_time > 0.0) ? cells_stepped / phase_time : 0.0);
+  }
+  f << "\r\n";
+}
+
+/// Copy the unpadded grid into bacteria and nutrients planes ordered by cell
+/// id.
+///
 /// @param [in] entities Entities struct with components defining the
 ///   nutrients and bacteria grids.
-void save_history_to_csv(
-    std::ofstream &f, const cli_parameters_t &cli_parameters, int step, int num_entities,
-    const Entities &entities) {
-  static bool first = true;
-  uint32_t real_cell = Entities::kFlagBacteria | Entities::kFlagNutrients;
+/// @param [out] bacteria Bacteria states of the unpadded grid.
+/// @param [out] nutrients Nutrients states of the unpadded grid.
+void copy_unpadded_grid(
+    const Entities &entities, component::Bacteria &bacteria,
+    component::Nutrients &nutrients) {
+  int cells_per_row = entities.cells_per_row();
+  int first_row = entities.first_unpadded_row();
+  int last_row = entities.last_unpadded_row();
+  int first_column = entities.first_unpadded_column();
+  int number_columns = entities.dimensions_.number_columns;
+
+  bacteria.resize(entities.dimensions_.number_rows * number_columns);
+  nutrients.resize(entities.dimensions_.number_rows * number_columns);
+  for (int row = first_row; row <= last_row; row++) {
+    int first_id = row * cells_per_row + first_column;
+    int first_cell_id = (row - first_row) * number_columns;
+    std::copy(
+        &entities.bacteria_[first_id], &entities.bacteria_[first_id] + number_columns,
+        &bacteria[first_cell_id]);
+    std::copy(
+        &entities.nutrients_[first_id], &entities.nutrients_[first_id] + number_columns,
+        &nutrients[first_cell_id]);
+  }
+}
 
-  if (first) {
+/// Copy the unpadded grid of one replica of an ensemble into bacteria and
+/// nutrients planes ordered by cell id.
+///
+/// @param [in] ensemble EnsembleEntities struct with components defining the
+///   nutrients and bacteria grids of every replica.
+/// @param [in] lane Replica to copy.
+/// @param [out] bacteria Bacteria states of the unpadded grid.
+/// @param [out] nutrients Nutrients states of the unpadded grid.
+void copy_unpadded_ensemble_lane(
+    const EnsembleEntities &ensemble, int lane, component::Bacteria &bacteria,
+    component::Nutrients &nutrients) {
+  int lanes = ensemble.lanes_;
+  int cells_per_row = ensemble.cells_per_row();
+  int first_row = ensemble.first_unpadded_row();
+  int last_row = ensemble.last_unpadded_row();
+  int first_column = ensemble.first_unpadded_column();
+  int number_columns = ensemble.dimensions_.number_columns;
+
+  bacteria.resize(ensemble.dimensions_.number_rows * number_columns);
+  nutrients.resize(ensemble.dimensions_.number_rows * number_columns);
+  for (int row = first_row; row <= last_row; row++) {
+    int first_id = row * cells_per_row + first_column;
+    int first_cell_id = (row - first_row) * number_columns;
+    for (int column = 0; column < number_columns; column++) {
+      bacteria[first_cell_id + column] =
+          ensemble.bacteria_[(first_id + column) * lanes + lane];
+      nutrients[first_cell_id + column] =
+          ensemble.nutrients_[(first_id + column) * lanes + lane];
+    }
+  }
+}
+
+/// Size of one frame in a binary history file.
+///
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @return Size of one frame in bytes.
+static uint64_t get_history_frame_bytes(const cli_parameters_t &cli_parameters) {
+  uint64_t num_cells = static_cast<uint64_t>(cli_parameters.grid_dimensions[0]) *
+                       cli_parameters.grid_dimensions[1];
+  uint64_t bacteria_bytes = (num_cells + 7) / 8 * 8;
+
+  return 2 * sizeof(uint32_t) + bacteria_bytes + num_cells * sizeof(float);
+}
+
+/// Open simulation history file if filename is provided and it is not open yet.
+///
+/// If no filename is set via the command-line interface, then no file will be
+/// saved. If a filename is provided, then the file is created and a header line
+/// is added. Binary and delta history files start with a data::HistoryHeader
+/// instead.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+void open_history_file(std::ofstream &f, const cli_parameters_t &cli_parameters) {
+  if (!f.is_open()) {
     if (cli_parameters.output_filename.empty()) {
       f.open(nullptr);
+    } else if (cli_parameters.history_format != "csv") {
+      f.open(cli_parameters.output_filename, std::ios::binary);
+      bool delta_encoded = cli_parameters.history_format == "delta";
+
+      data::HistoryHeader header{};
+      std::memcpy(header.magic, "BIOFILM", 8);
+      header.version = 1;
+      header.header_bytes = sizeof(data::HistoryHeader);
+      header.number_rows = cli_parameters.grid_dimensions[0];
+      header.number_columns = cli_parameters.grid_dimensions[1];
+      header.frame_bytes = delta_encoded ? 0 : get_history_frame_bytes(cli_parameters);
+      header.seed = cli_parameters.seed;
+      header.num_steps = cli_parameters.num_steps;
+      header.diffusion_substeps = cli_parameters.diffusion_substeps;
+      header.probability_bacteria = cli_parameters.probability_bacteria;
+      header.probability_divide = cli_parameters.probability_divide;
+      header.consume_amount = cli_parameters.consume_amount;
+      header.diffusion_rate = cli_parameters.diffusion_rate;
+      header.max_nutrient = cli_parameters.max_nutrient;
+      header.encoding = delta_encoded ? 1 : 0;
+      header.keyframe_interval = cli_parameters.keyframe_interval;
+      header.nutrient_tolerance = cli_parameters.nutrient_tolerance;
+      f.write(reinterpret_cast<const char *>(&header), sizeof(header));
     } else {
       f.open(cli_parameters.output_filename);
       f << "step"
@@ -329,18 +537,323 @@ void save_history_to_csv(
         << "nutrient_state"
         << "\r\n";
     }
-    first = false;
+  }
+}
+
+/// Finish the simulation history file, if one is open.
+///
+/// Binary and delta history files end with the byte offset of every frame
+/// followed by a data::HistoryFooter, so readers can jump straight to any frame
+/// (or, for delta files, to the keyframe before it).
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] frame_offsets Byte offset of every frame saved to the file.
+void close_history_file(
+    std::ofstream &f, const cli_parameters_t &cli_parameters,
+    const std::vector<uint64_t> &frame_offsets) {
+  if (!f.is_open()) {
+    return;
   }
 
+  if (cli_parameters.history_format != "csv") {
+    data::HistoryFooter footer{};
+    footer.index_offset = f.tellp();
+    footer.number_frames = frame_offsets.size();
+    std::memcpy(footer.magic, "BIOFIDX", 8);
+
+    f.write(
+        reinterpret_cast<const char *>(frame_offsets.data()),
+        frame_offsets.size() * sizeof(uint64_t));
+    f.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+  }
+
+  f.close();
+}
+
+/// Save simulation history snapshots in the format set via the command-line
+/// interface, if filename is provided.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void save_history(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const Entities &entities) {
+  if (cli_parameters.history_format == "binary") {
+    save_history_to_binary(f, cli_parameters, step, entities);
+  } else {
+    save_history_to_csv(f, cli_parameters, step, entities);
+  }
+}
+
+/// Save simulation history snapshots of the unpadded grid in the format set via
+/// the command-line interface, if filename is provided.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] bacteria Bacteria states of the unpadded grid, ordered by cell id.
+/// @param [in] nutrients Nutrients states of the unpadded grid, ordered by cell
+///   id.
+void save_history(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients) {
+  if (cli_parameters.history_format == "binary") {
+    save_history_to_binary(f, cli_parameters, step, bacteria, nutrients);
+  } else {
+    save_history_to_csv(f, cli_parameters, step, bacteria, nutrients);
+  }
+}
+
+/// Save simulation history snapshot as a binary frame if filename is provided.
+///
+/// Bacteria states are written row by row straight from the bacteria component,
+/// and nutrients are converted to single precision one row at a time.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void save_history_to_binary(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const Entities &entities) {
+  open_history_file(f, cli_parameters);
+
+  if (f) {
+    int cells_per_row = entities.cells_per_row();
+    int first_row = entities.first_unpadded_row();
+    int last_row = entities.last_unpadded_row();
+    int first_column = entities.first_unpadded_column();
+    int number_columns = entities.dimensions_.number_columns;
+    int num_cells = entities.dimensions_.number_rows * number_columns;
+
+    int32_t frame_step[2] = {step, 0};
+    f.write(reinterpret_cast<const char *>(frame_step), sizeof(frame_step));
+
+    for (int row = first_row; row <= last_row; row++) {
+      const data::BacteriumState *bacteria =
+          &entities.bacteria_[row * cells_per_row + first_column];
+      f.write(reinterpret_cast<const char *>(bacteria), number_columns);
+    }
+    std::vector<char> padding((num_cells + 7) / 8 * 8 - num_cells, 0);
+    f.write(padding.data(), padding.size());
+
+    std::vector<float> nutrients(number_columns);
+    for (int row = first_row; row <= last_row; row++) {
+      const data::Nutrient *row_nutrients =
+          &entities.nutrients_[row * cells_per_row + first_column];
+      std::copy(row_nutrients, row_nutrients + number_columns, nutrients.begin());
+      f.write(
+          reinterpret_cast<const char *>(nutrients.data()),
+          number_columns * sizeof(float));
+    }
+  }
+}
+
+/// Save simulation history snapshot of the unpadded grid as a binary frame if
+/// filename is provided.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] bacteria Bacteria states of the unpadded grid, ordered by cell id.
+/// @param [in] nutrients Nutrients states of the unpadded grid, ordered by cell
+///   id.
+void save_history_to_binary(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients) {
+  open_history_file(f, cli_parameters);
+
   if (f) {
+    int num_cells = bacteria.size();
+
+    int32_t frame_step[2] = {step, 0};
+    f.write(reinterpret_cast<const char *>(frame_step), sizeof(frame_step));
+
+    f.write(reinterpret_cast<const char *>(bacteria.data()), num_cells);
+    std::vector<char> padding((num_cells + 7) / 8 * 8 - num_cells, 0);
+    f.write(padding.data(), padding.size());
+
+    std::vector<float> nutrients_plane(nutrients.begin(), nutrients.end());
+    f.write(
+        reinterpret_cast<const char *>(nutrients_plane.data()),
+        num_cells * sizeof(float));
+  }
+}
+
+/// Save simulation history snapshots to csv format if filename is provided.
+///
+/// If no filename is set via the command-line interface, then no file will be
+/// saved. If a filename is provided, then if the file is empty (or doesn't
+/// exist), it will be created and a header line will be added. The simulation
+/// history snapshots are then accumulated in the file stream buffer to be saved
+/// to disk. The output file can be used for generating animations.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] entities Entities struct with components defining the
+///   nutrients and bacteria grids.
+void save_history_to_csv(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const Entities &entities) {
+  open_history_file(f, cli_parameters);
+
+  if (f) {
+    int cells_per_row = entities.cells_per_row();
     int cell_id = 0;
-    for (int id = 0; id < num_entities; id++) {
-      if ((entities.flags_[id] & real_cell) == real_cell) {
-        f << step << "," << cell_id << "," << entities.bacteria_[id] << ","
-          << entities.nutrients_[id] << "\r\n";
+    for (int row = entities.first_unpadded_row(); row <= entities.last_unpadded_row();
+         row++) {
+      for (int column = entities.first_unpadded_column();
+           column <= entities.last_unpadded_column(); column++) {
+        Entities::EntityID id = row * cells_per_row + column;
+        f << step << "," << cell_id << "," << static_cast<int>(entities.bacteria_[id])
+          << "," << entities.nutrients_[id] << "\r\n";
         cell_id++;
       }
     }
   }
 }
+
+/// Save simulation history snapshots of the unpadded grid to csv format if
+/// filename is provided.
+///
+/// Used when the grid is not held in a single Entities struct, for example
+/// after gathering the row slabs of every process. The output matches the
+/// Entities version.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] bacteria Bacteria states of the unpadded grid, ordered by cell id.
+/// @param [in] nutrients Nutrients states of the unpadded grid, ordered by cell
+///   id.
+void save_history_to_csv(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients) {
+  open_history_file(f, cli_parameters);
+
+  if (f) {
+    int num_cells = bacteria.size();
+    for (int cell_id = 0; cell_id < num_cells; cell_id++) {
+      f << step << "," << cell_id << "," << static_cast<int>(bacteria[cell_id]) << ","
+        << nutrients[cell_id] << "\r\n";
+    }
+  }
+}
+
+/// Append an unsigned integer to a byte buffer as a variable-length integer.
+///
+/// Uses the LEB128 encoding, seven bits per byte starting with the lowest bits,
+/// with the high bit of every byte but the last one set. Small values take a
+/// single byte.
+///
+/// @param [in] value Value to append.
+/// @param [in,out] encoded Byte buffer.
+static void append_varint(uint64_t value, std::vector<char> &encoded) {
+  while (value >= 0x80u) {
+    encoded.push_back(static_cast<char>((value & 0x7Fu) | 0x80u));
+    value >>= 7u;
+  }
+  encoded.push_back(static_cast<char>(value));
+}
+
+/// Append a run-length encoding of the zeros in a delta to a byte buffer.
+///
+/// The delta is split into runs of a count of zeros to skip and a count of
+/// nonzero values, followed by the nonzero values themselves. Counts and values
+/// are all stored as variable-length integers.
+///
+/// @param [in] delta Values to encode.
+/// @param [in,out] encoded Byte buffer the runs are appended to.
+template <typename T>
+static void append_zero_runs(const std::vector<T> &delta, std::vector<char> &encoded) {
+  std::size_t num_values = delta.size();
+  std::size_t i = 0;
+
+  while (i < num_values) {
+    std::size_t first_zero = i;
+    while (i < num_values && delta[i] == 0) {
+      i++;
+    }
+    std::size_t first_value = i;
+    while (i < num_values && delta[i] != 0) {
+      i++;
+    }
+
+    append_varint(first_value - first_zero, encoded);
+    append_varint(i - first_value, encoded);
+    for (std::size_t j = first_value; j < i; j++) {
+      append_varint(delta[j], encoded);
+    }
+  }
+}
+
+/// Save simulation history snapshot of the unpadded grid as a delta frame if
+/// filename is provided.
+///
+/// Every keyframe_interval frames, a keyframe is saved that does not depend on
+/// the previous frames.
+///
+/// @param [in,out] f The file stream buffer for the output file.
+/// @param [in] cli_parameters Simulation parameters passed via the
+///   command-line.
+/// @param [in] step The current step number in the simulation.
+/// @param [in] bacteria Bacteria states of the unpadded grid, ordered by cell id.
+/// @param [in] nutrients Nutrients states of the unpadded grid, ordered by cell
+///   id.
+/// @param [in,out] state Previous frame, updated to this frame.
+void save_history_to_delta(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients,
+    data::HistoryDeltaState &state) {
+  open_history_file(f, cli_parameters);
+
+  if (f) {
+    int num_cells = bacteria.size();
+    bool keyframe = state.number_frames % cli_parameters.keyframe_interval == 0;
+
+    // Keyframes are encoded against a frame of zeros.
+    if (keyframe) {
+      state.bacteria.assign(num_cells, 0);
+      state.nutrients.assign(num_cells, 0);
+    }
+
+    std::vector<data::BacteriumState> bacteria_delta(num_cells);
+    std::vector<uint32_t> nutrients_delta(num_cells);
+    for (int cell_id = 0; cell_id < num_cells; cell_id++) {
+      uint32_t quantized = static_cast<uint32_t>(
+          std::lround(nutrients[cell_id] / cli_parameters.nutrient_tolerance));
+      bacteria_delta[cell_id] = bacteria[cell_id] ^ state.bacteria[cell_id];
+      nutrients_delta[cell_id] = quantized ^ state.nutrients[cell_id];
+      state.bacteria[cell_id] = bacteria[cell_id];
+      state.nutrients[cell_id] = quantized;
+    }
+
+    std::vector<char> bacteria_runs;
+    std::vector<char> nutrients_runs;
+    append_zero_runs(bacteria_delta, bacteria_runs);
+    append_zero_runs(nutrients_delta, nutrients_runs);
+
+    int32_t frame_step[2] = {step, keyframe ? 1 : 0};
+    uint64_t frame_sizes[2] = {bacteria_runs.size(), nutrients_runs.size()};
+    f.write(reinterpret_cast<const char *>(frame_step), sizeof(frame_step));
+    f.write(reinterpret_cast<const char *>(frame_sizes), sizeof(frame_sizes));
+    f.write(bacteria_runs.data(), bacteria_runs.size());
+    f.write(nutrients_runs.data(), nutrients_runs.size());
+
+    state.number_frames++;
+  }
+}
 }   // namespace utilities
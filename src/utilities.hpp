@@ -2,12 +2,16 @@
 #define BIOFILM_SIMULATION_INDEX_CONVERTER_HPP
 
 #include <chrono>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include <cli.hpp>
 #include <components.hpp>
 #include <data.hpp>
+#include <ensemble_entities.hpp>
 #include <entities.hpp>
+#include <phase_timers.hpp>
 
 namespace utilities {
 enum {
@@ -37,14 +41,72 @@ struct IndexConverter {
   data::Index operator()(int id);
 };
 
+struct CellIdConverter {
+  const int knumber_rows_;
+  const int knumber_columns_;
+  const int ksize_padding_;
+  const int krow_offset_;
+
+  explicit CellIdConverter(const data::Dimensions &dimensions, int row_offset = 0);
+  int operator()(const data::Index &index) const;
+};
+
 bool check_if_empty(std::string filename);
 
 void save_benchmark_to_csv(
-    const cli_parameters_t &cli_parameters, double simulation_time, std::string run_mode);
+    const cli_parameters_t &cli_parameters, double simulation_time,
+    double history_stall_time, int converged_step, const PhaseTimers &phase_timers,
+    std::string run_mode, int num_threads, int num_processes);
+
+void write_benchmark_header(std::ostream &f);
+
+void write_benchmark_row(
+    std::ostream &f, const cli_parameters_t &cli_parameters, double simulation_time,
+    double history_stall_time, int converged_step, const PhaseTimers &phase_timers,
+    std::string run_mode, int num_threads, int num_processes);
+
+void copy_unpadded_grid(
+    const Entities &entities, component::Bacteria &bacteria,
+    component::Nutrients &nutrients);
+
+void copy_unpadded_ensemble_lane(
+    const EnsembleEntities &ensemble, int lane, component::Bacteria &bacteria,
+    component::Nutrients &nutrients);
+
+void open_history_file(std::ofstream &f, const cli_parameters_t &cli_parameters);
+
+void close_history_file(
+    std::ofstream &f, const cli_parameters_t &cli_parameters,
+    const std::vector<uint64_t> &frame_offsets);
+
+void save_history(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const Entities &entities);
+
+void save_history(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients);
+
+void save_history_to_binary(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const Entities &entities);
+
+void save_history_to_binary(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients);
 
 void save_history_to_csv(
-    std::ofstream &f, const cli_parameters_t &cli_parameters, int step, int num_entities,
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
     const Entities &entities);
+
+void save_history_to_csv(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients);
+
+void save_history_to_delta(
+    std::ofstream &f, const cli_parameters_t &cli_parameters, int step,
+    const component::Bacteria &bacteria, const component::Nutrients &nutrients,
+    data::HistoryDeltaState &state);
 }   // namespace utilities
 
 #endif   // BIOFILM_SIMULATION_INDEX_CONVERTER_HPP